@@ -0,0 +1,98 @@
+#pragma once
+#include <new>
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Counts allocations made through the global operator new while enabled.
+// This header replaces the global allocation functions, so it must be included in exactly one translation unit of a program.
+class AllocCounter
+{
+    static inline std::atomic<bool> enabled{false};
+    static inline std::atomic<uint64_t> allocations{0}, bytes{0};
+
+public:
+    struct Counts
+    {
+        uint64_t allocations, bytes;
+    };
+
+    static void start()
+    {
+        allocations = 0;
+        bytes = 0;
+        enabled = true;
+    }
+
+    static Counts stop()
+    {
+        enabled = false;
+        return Counts{allocations, bytes};
+    }
+
+    static void *allocate(size_t size, size_t alignment = 0)
+    {
+        if (enabled.load(std::memory_order_relaxed)) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+        if (size == 0)
+            size = 1;
+        if (alignment > alignof(std::max_align_t)) {
+            void *p;
+            return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+        }
+        return malloc(size);
+    }
+};
+
+void *operator new  (size_t size)
+{
+    if (void *p = AllocCounter::allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size)
+{
+    if (void *p = AllocCounter::allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new  (size_t size, std::align_val_t alignment)
+{
+    if (void *p = AllocCounter::allocate(size, size_t(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    if (void *p = AllocCounter::allocate(size, size_t(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new  (size_t size, const std::nothrow_t&) noexcept {return AllocCounter::allocate(size);}
+void *operator new[](size_t size, const std::nothrow_t&) noexcept {return AllocCounter::allocate(size);}
+void *operator new  (size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {return AllocCounter::allocate(size, size_t(alignment));}
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {return AllocCounter::allocate(size, size_t(alignment));}
+
+// GCC cannot see that the replaced operator new returns memory from malloc
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete  (void *p) noexcept {free(p);}
+void operator delete[](void *p) noexcept {free(p);}
+void operator delete  (void *p, size_t) noexcept {free(p);}
+void operator delete[](void *p, size_t) noexcept {free(p);}
+void operator delete  (void *p, std::align_val_t) noexcept {free(p);}
+void operator delete[](void *p, std::align_val_t) noexcept {free(p);}
+void operator delete  (void *p, size_t, std::align_val_t) noexcept {free(p);}
+void operator delete[](void *p, size_t, std::align_val_t) noexcept {free(p);}
+void operator delete  (void *p, const std::nothrow_t&) noexcept {free(p);}
+void operator delete[](void *p, const std::nothrow_t&) noexcept {free(p);}
+void operator delete  (void *p, std::align_val_t, const std::nothrow_t&) noexcept {free(p);}
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t&) noexcept {free(p);}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,241 @@
+#pragma once
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "protocol_loops.hpp"
+#include "alloc_counter.hpp"
+#include "perf_counters.hpp"
+
+struct BenchResult
+{
+    std::string container, protocol;
+    std::string mode; // e.g. page cache state for I/O benchmarks, omitted when empty
+    int64_t n = 0;
+    int64_t passes = 0; // total number of timed passes over the collection
+    double ns_per_element = 0, ns_per_element_median = 0, elements_per_second = 0;
+    uint64_t checksum = 0;
+    int64_t allocations = -1; // heap allocations of one pass, when counted
+    std::vector<std::pair<std::string, double>> metrics; // additional per-element figures, written to JSON as is
+};
+
+struct BenchOptions
+{
+    double min_time = 0.2;   // seconds spent measuring each container × protocol × size
+    const char *json_path = nullptr;
+    bool count_allocations = false;
+    bool perf = false;
+    std::string containers, protocols; // comma-separated filters, empty means all
+
+    static bool in_list(const std::string &list, const std::string &name)
+    {
+        return list.empty() || (',' + list + ',').find(',' + name + ',') != std::string::npos;
+    }
+
+    bool selected_container(const char *name) const {return in_list(containers, name);}
+    bool selected_protocol (const char *name) const {return in_list(protocols , name);}
+
+    // Recognizes the options common to all benchmarks; returns false if `argv[i]` is not one of them
+    bool parse(int argc, char **argv, int &i)
+    {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--alloc") == 0) {
+            count_allocations = true;
+            return true;
+        }
+        if (strcmp(arg, "--perf") == 0) {
+            perf = true;
+            return true;
+        }
+        if (i + 1 >= argc)
+            return false;
+        if (strcmp(arg, "--min-time") == 0)
+            min_time = atof(argv[++i]);
+        else if (strcmp(arg, "--json") == 0)
+            json_path = argv[++i];
+        else if (strcmp(arg, "--container") == 0)
+            containers = argv[++i];
+        else if (strcmp(arg, "--protocol") == 0)
+            protocols = argv[++i];
+        else
+            return false;
+        return true;
+    }
+
+    static const char *usage() {return "  --min-time SECONDS   time spent measuring each case (default 0.2)\n"
+                                       "  --json FILE          write results as JSON\n"
+                                       "  --alloc              also count heap allocations per element, and fail if a protocol marked zero-alloc allocates per element\n"
+                                       "  --perf               also collect hardware performance counters per element (Linux), on the calling thread only\n"
+                                       "  --container A,B,...  only these containers\n"
+                                       "  --protocol P,Q,...   only these protocols (C++, D, Python, Rust, Java, C#, 11l, iterate, for_each, raw)\n";}
+};
+
+// Times `pass()`, which makes one full pass over `n` elements and returns its checksum. Passes are grouped into samples of at least a millisecond so that timer resolution does not matter for small `n`, and samples are repeated until `options.min_time` is spent.
+template <typename Pass> BenchResult measure(const char *container, const char *protocol, int64_t n, Pass &&pass, const BenchOptions &options)
+{
+    using clock = std::chrono::steady_clock;
+    auto seconds_since = [](clock::time_point t) {return std::chrono::duration<double>(clock::now() - t).count();};
+
+    BenchResult r;
+    r.container = container;
+    r.protocol = protocol;
+    r.n = n;
+    r.checksum = pass(); // warm-up
+
+    int64_t passes_per_sample = 1;
+    for (auto t = clock::now(); ; t = clock::now()) {
+        for (int64_t i = 0; i < passes_per_sample; i++)
+            pass();
+        if (seconds_since(t) >= 1e-3)
+            break;
+        passes_per_sample *= 2;
+    }
+
+    std::vector<double> samples;
+    auto start = clock::now();
+    do {
+        auto t = clock::now();
+        for (int64_t i = 0; i < passes_per_sample; i++)
+            if (pass() != r.checksum) {
+                fprintf(stderr, "%s %s: checksum differs between passes\n", container, protocol);
+                exit(1);
+            }
+        samples.push_back(seconds_since(t) * 1e9 / double(passes_per_sample * n));
+        r.passes += passes_per_sample;
+    } while (samples.size() < 3 || seconds_since(start) < options.min_time);
+
+    std::sort(samples.begin(), samples.end());
+    r.ns_per_element = samples.front();
+    r.ns_per_element_median = samples[samples.size() / 2];
+    r.elements_per_second = 1e9 / r.ns_per_element;
+    return r;
+}
+
+// A zero-alloc protocol may allocate a few times while setting up a pass (e.g. the buffer of an std::ifstream), but never per element
+const uint64_t max_setup_allocations = 16;
+
+// Makes one extra pass with allocation counting enabled and adds the per-element figures to `r`. Returns false if the protocol is `zero_alloc` but allocated more than setting up a pass may, or more than over the fewer elements of `smaller` (the result of the same protocol over a smaller collection, if any): below `max_setup_allocations` elements, per-element allocations only show as growth with `n`.
+template <typename Pass> bool count_allocations(BenchResult &r, Pass &&pass, bool zero_alloc, const BenchResult *smaller = nullptr)
+{
+    AllocCounter::start();
+    pass();
+    AllocCounter::Counts counts = AllocCounter::stop();
+    r.allocations = int64_t(counts.allocations);
+    double n = double(std::max(r.n, int64_t(1)));
+    r.metrics.emplace_back("allocs_per_element", double(counts.allocations) / n);
+    r.metrics.emplace_back("alloc_bytes_per_element", double(counts.bytes) / n);
+    if (!zero_alloc)
+        return true;
+    if (counts.allocations > max_setup_allocations) {
+        fprintf(stderr, "%s %s is marked zero-alloc, but made %llu allocations (%llu bytes) over %lld elements\n", r.container.c_str(), r.protocol.c_str(),
+                (unsigned long long)counts.allocations, (unsigned long long)counts.bytes, (long long)r.n);
+        return false;
+    }
+    if (smaller != nullptr && smaller->allocations >= 0 && smaller->n < r.n && r.allocations > smaller->allocations) {
+        fprintf(stderr, "%s %s is marked zero-alloc, but made %lld allocations over %lld elements against %lld over %lld\n", r.container.c_str(), r.protocol.c_str(),
+                (long long)r.allocations, (long long)r.n, (long long)smaller->allocations, (long long)smaller->n);
+        return false;
+    }
+    return true;
+}
+
+// Makes `passes` extra passes with hardware performance counters enabled and adds the counts per element to `r`
+template <typename Pass> void count_perf_events(BenchResult &r, Pass &&pass, int64_t passes = 1)
+{
+    static PerfCounters counters;
+    if (!counters.available()) {
+        static bool reported = false;
+        if (!reported) {
+            reported = true;
+            fprintf(stderr, "note: perf_event_open is not available (no PMU, or denied by /proc/sys/kernel/perf_event_paranoid), --perf is ignored\n");
+        }
+        return;
+    }
+
+    counters.start();
+    for (int64_t i = 0; i < passes; i++)
+        pass();
+    auto counts = counters.stop();
+
+    double elements = double(std::max(r.n, int64_t(1)) * passes);
+    double cycles = 0, instructions = 0;
+    for (auto &&c : counts) {
+        r.metrics.emplace_back(c.first + "_per_element", c.second / elements);
+        if (c.first == "cycles")
+            cycles = c.second;
+        else if (c.first == "instructions")
+            instructions = c.second;
+    }
+    if (cycles > 0 && instructions > 0)
+        r.metrics.emplace_back("ipc", instructions / cycles);
+    if (counters.kernel_excluded())
+        r.metrics.emplace_back("perf_user_only", 1);
+}
+
+inline void print_result_header()
+{
+    printf("%-16s %-9s %12s %12s %12s %14s\n", "container", "protocol", "n", "ns/element", "median", "Melements/s");
+}
+
+inline void print_result(const BenchResult &r)
+{
+    printf("%-16s %-9s %12lld %12.3f %12.3f %14.1f", r.container.c_str(), r.protocol.c_str(), (long long)r.n, r.ns_per_element, r.ns_per_element_median, r.elements_per_second / 1e6);
+    if (!r.mode.empty())
+        printf("  %s", r.mode.c_str());
+    for (auto &&m : r.metrics)
+        printf("  %s=%.3f", m.first.c_str(), m.second);
+    printf("\n");
+    fflush(stdout);
+}
+
+inline void write_json_string(FILE *f, const std::string &s)
+{
+    fputc('"', f);
+    for (unsigned char c : s)
+        if (c == '"' || c == '\\')
+            fprintf(f, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    fputc('"', f);
+}
+
+inline bool write_json(const char *path, const char *benchmark, const std::vector<BenchResult> &results)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "{\n  \"benchmark\": ");
+    write_json_string(f, benchmark);
+    fprintf(f, ",\n  \"results\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        fprintf(f, i == 0 ? "\n    {" : ",\n    {");
+        fprintf(f, "\"container\": ");
+        write_json_string(f, r.container);
+        fprintf(f, ", \"protocol\": ");
+        write_json_string(f, r.protocol);
+        if (!r.mode.empty()) {
+            fprintf(f, ", \"mode\": ");
+            write_json_string(f, r.mode);
+        }
+        fprintf(f, ", \"n\": %lld, \"passes\": %lld, \"ns_per_element\": %.4f, \"ns_per_element_median\": %.4f, \"elements_per_second\": %.1f, \"checksum\": %llu",
+                (long long)r.n, (long long)r.passes, r.ns_per_element, r.ns_per_element_median, r.elements_per_second, (unsigned long long)r.checksum);
+        for (auto &&m : r.metrics) {
+            fprintf(f, ", ");
+            write_json_string(f, m.first);
+            fprintf(f, ": %.4f", m.second);
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n  ]\n}\n");
+    return fclose(f) == 0;
+}
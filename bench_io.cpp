@@ -0,0 +1,611 @@
+#include <random>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "bench.hpp"
+#include "read_lines.hpp"
+#include "mapped_lines.hpp"
+#include "block_lines.hpp"
+#include "parallel_lines.hpp"
+#include "read_ahead_lines.hpp"
+#include "uring_lines.hpp"
+#include "direct_lines.hpp"
+#include "line_index.hpp"
+#include "reverse_lines.hpp"
+#include "records.hpp"
+#include "matching_lines.hpp"
+#include "utf8.hpp"
+#include "decompressed_lines.hpp"
+#include "line_arena.hpp"
+#include "dir_getdents.hpp"
+#include "parallel_dir_walk.hpp"
+#include "dir_stat.hpp"
+
+// Accepts plain byte counts as well as K, M and G suffixes (powers of 1024)
+static int64_t parse_size(const char *s)
+{
+    char *end;
+    double value = strtod(s, &end);
+    switch (*end) {
+    case 'G': case 'g': value *= 1024; [[fallthrough]];
+    case 'M': case 'm': value *= 1024; [[fallthrough]];
+    case 'K': case 'k': value *= 1024;
+    }
+    return int64_t(value);
+}
+
+// Line length distribution of generated files: "fixed:N", "uniform:MIN:MAX" or "exp:MEAN" (exponential, i.e. mostly short lines with a long tail)
+class LineLengths
+{
+    enum {Fixed, Uniform, Exponential} kind = Uniform;
+    double a = 0, b = 160;
+    std::mt19937_64 rng;
+
+public:
+    LineLengths(uint64_t seed = 1) : rng(seed) {}
+
+    bool parse(const char *spec)
+    {
+        if (sscanf(spec, "fixed:%lf", &a) == 1)
+            kind = Fixed;
+        else if (sscanf(spec, "uniform:%lf:%lf", &a, &b) == 2 && a <= b)
+            kind = Uniform;
+        else if (sscanf(spec, "exp:%lf", &a) == 1 && a > 0)
+            kind = Exponential;
+        else
+            return false;
+        return a >= 0;
+    }
+
+    int64_t next()
+    {
+        switch (kind) {
+        case Fixed:
+            return int64_t(a);
+        case Uniform:
+            return std::uniform_int_distribution<int64_t>(int64_t(a), int64_t(b))(rng);
+        case Exponential:
+            return int64_t(std::exponential_distribution<double>(1 / a)(rng));
+        }
+        return 0;
+    }
+};
+
+static bool generate_lines(const char *fname, int64_t size, LineLengths &lengths)
+{
+    FILE *f = fopen(fname, "wb");
+    if (f == NULL) {
+        perror(fname);
+        return false;
+    }
+
+    // Line bodies are slices of a random text, so generation runs at disk speed
+    std::string text(1 << 20, ' ');
+    std::mt19937_64 rng(2);
+    for (char &c : text)
+        c = "abcdefghijklmnopqrstuvwxyz0123456789  ,.;:-_ABCDEFGHIJKLMNOPQRSTUVWXYZ"[rng() % 72];
+
+    std::vector<char> buf;
+    buf.reserve(1 << 22);
+    int64_t written = 0, lines = 0;
+    while (written < size) {
+        int64_t len = std::min(lengths.next(), size - written - 1);
+        while (len > 0) {
+            int64_t part = std::min(len, int64_t(text.size()));
+            size_t offset = rng() % (text.size() - part + 1);
+            buf.insert(buf.end(), text.data() + offset, text.data() + offset + part);
+            written += part;
+            len -= part;
+        }
+        buf.push_back('\n');
+        written++;
+        lines++;
+        if (buf.size() >= (1 << 22) - 2 * text.size() || written >= size) {
+            if (fwrite(buf.data(), 1, buf.size(), f) != buf.size()) {
+                perror(fname);
+                fclose(f);
+                return false;
+            }
+            buf.clear();
+        }
+    }
+    if (fclose(f) != 0) {
+        perror(fname);
+        return false;
+    }
+    printf("%s: %lld bytes, %lld lines\n", fname, (long long)written, (long long)lines);
+    return true;
+}
+
+// Creates `entries` empty files in `path` and, while `depth` > 0, `fanout` subdirectories filled the same way with depth - 1
+static bool generate_dir(const std::string &path, int64_t entries, int depth, int fanout, int64_t &total)
+{
+    if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        perror(path.c_str());
+        return false;
+    }
+    char name[32];
+    for (int64_t i = 0; i < entries; i++) {
+        snprintf(name, sizeof(name), "/f%08lld.txt", (long long)i);
+        int fd = open((path + name).c_str(), O_CREAT | O_WRONLY, 0644);
+        if (fd < 0) {
+            perror((path + name).c_str());
+            return false;
+        }
+        close(fd);
+        total++;
+    }
+    if (depth > 0)
+        for (int i = 0; i < fanout; i++) {
+            snprintf(name, sizeof(name), "/d%04d", i);
+            total++;
+            if (!generate_dir(path + name, entries, depth - 1, fanout, total))
+                return false;
+        }
+    return true;
+}
+
+enum class Cache {Warm, Cold};
+
+// Evicts cached data of a file, or of the files directly inside a directory
+class PageCacheDropper
+{
+    bool can_drop_caches = true;
+
+    static bool drop_caches()
+    {
+        sync();
+        int fd = open("/proc/sys/vm/drop_caches", O_WRONLY);
+        if (fd < 0)
+            return false;
+        bool ok = write(fd, "3", 1) == 1;
+        close(fd);
+        return ok;
+    }
+
+    static void fadvise_dontneed(const std::string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISDIR(st.st_mode)) {
+            if (DIR *dir_handle = fdopendir(fd)) {
+                while (dirent *de = readdir(dir_handle))
+                    if (de->d_type == DT_REG)
+                        fadvise_dontneed(path + '/' + de->d_name);
+                closedir(dir_handle);
+                return;
+            }
+        }
+        else {
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+        close(fd);
+    }
+
+public:
+    void drop(const std::string &path)
+    {
+        if (can_drop_caches && drop_caches())
+            return;
+        if (can_drop_caches) {
+            can_drop_caches = false;
+            fprintf(stderr, "note: cannot write /proc/sys/vm/drop_caches (not root?), cold runs use posix_fadvise(DONTNEED), which leaves directory metadata cached\n");
+        }
+        fadvise_dontneed(path);
+    }
+};
+
+class Benchmark
+{
+    BenchOptions options;
+    std::vector<Cache> caches;
+    int passes;
+    unsigned threads;
+    PageCacheDropper dropper;
+    std::vector<BenchResult> results;
+    bool alloc_regression = false, small_input_reported = false;
+
+    struct alignas(64) Sum // one per thread, on a cache line of its own
+    {
+        uint64_t value;
+    };
+
+    // Protocols that keep the current element in a reused buffer. The value-returning Python, Rust and Java protocols of Lines, Dir and DirWalk construct an std::string per element, while the other Lines containers (ReusedLines and ArenaLines included) and GetdentsDir return views.
+    static bool marked_zero_alloc(const char *container, const char *protocol)
+    {
+        if (strcmp(container, "ParallelLines") == 0 || strcmp(protocol, "seek") == 0) // every chunk or seek reads into a buffer of its own
+            return false;
+        if (strcmp(container, "ParallelDirWalk") == 0) // every directory found is queued as a string
+            return false;
+        return !BenchOptions::in_list("Lines,Dir,DirWalk", container) || !BenchOptions::in_list("Python,Rust,Java", protocol);
+    }
+
+    // Protocols which work on threads of their own (a pool, or a reading thread): the counters of `count_perf_events()` would only count the calling thread, which mostly waits for them
+    static bool works_on_other_threads(const char *container, const char *protocol)
+    {
+        if (strcmp(container, "DecompressedLines") == 0)
+            return strcmp(protocol, "no_thread") != 0;
+        return BenchOptions::in_list("ParallelLines,ParallelDirWalk,ReadAheadLines", container);
+    }
+
+public:
+    Benchmark(const BenchOptions &options, const std::vector<Cache> &caches, int passes, unsigned threads) : options(options), caches(caches), passes(passes), threads(threads) {}
+
+    // Unlike `measure()`, every pass is timed on its own, as a cold pass has to be preceded by evicting `path` from the page cache
+    template <typename Pass> void run(const char *container, const char *protocol, const std::string &path, int64_t n, int64_t bytes, Pass &&pass)
+    {
+        if (!options.selected_container(container) || !options.selected_protocol(protocol))
+            return;
+
+        for (Cache cache : caches) {
+            BenchResult r;
+            r.container = container;
+            r.protocol = protocol;
+            r.mode = cache == Cache::Cold ? "cold" : "warm";
+            r.n = n;
+            if (cache == Cache::Warm)
+                r.checksum = pass();
+
+            std::vector<double> samples;
+            for (int i = 0; i < passes; i++) {
+                if (cache == Cache::Cold)
+                    dropper.drop(path);
+                auto t = std::chrono::steady_clock::now();
+                r.checksum = pass();
+                samples.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count() * 1e9 / double(std::max(n, int64_t(1))));
+                r.passes++;
+            }
+            std::sort(samples.begin(), samples.end());
+            r.ns_per_element = samples.front();
+            r.ns_per_element_median = samples[samples.size() / 2];
+            r.elements_per_second = 1e9 / r.ns_per_element;
+            if (bytes > 0)
+                r.metrics.emplace_back("mb_per_second", double(bytes) / (r.ns_per_element * double(n)) * 1e3);
+            if (options.count_allocations && cache == Cache::Warm && !count_allocations(r, pass, marked_zero_alloc(container, protocol)))
+                alloc_regression = true;
+            if (options.count_allocations && uint64_t(n) <= max_setup_allocations && !small_input_reported) { // the size of the input is the only one measured
+                small_input_reported = true;
+                fprintf(stderr, "note: over an input of %lld elements or fewer, --alloc cannot tell per-element allocations from setup ones (use a larger input)\n", (long long)max_setup_allocations);
+            }
+            if (options.perf && works_on_other_threads(container, protocol))
+                r.metrics.emplace_back("perf_calling_thread_only", 1); // not counted, rather than reported as comparable to the other rows
+            else if (options.perf) {
+                if (cache == Cache::Cold)
+                    dropper.drop(path);
+                count_perf_events(r, pass);
+            }
+            print_result(r);
+            results.push_back(std::move(r));
+        }
+    }
+
+    template <typename Collection> void run_all_protocols(const char *container, const std::string &path, int64_t n, int64_t bytes, Collection &collection)
+    {
+        for (int p = 0; p < (int)Protocol::COUNT; p++)
+            run(container, protocol_name(Protocol(p)), path, n, bytes, [&collection, p]() {return run_protocol(Protocol(p), collection);});
+    }
+
+    void lines(const char *fname)
+    {
+        struct stat st;
+        if (stat(fname, &st) != 0) {
+            perror(fname);
+            return;
+        }
+        Lines lines(fname);
+        int64_t n = 0;
+        lines.iterate([&n](const std::string &) {n++;});
+        run_all_protocols("Lines", fname, n, st.st_size, lines);
+
+        ReusedLines reused_lines(fname);
+        run_all_protocols("ReusedLines", fname, n, st.st_size, reused_lines);
+
+        LineArena arena;
+        ArenaLines arena_lines(Lines(fname), arena);
+        for (int p = 0; p < (int)Protocol::COUNT; p++)
+            run("ArenaLines", protocol_name(Protocol(p)), fname, n, st.st_size, [&arena, &arena_lines, p]() {
+                arena.clear(); // every pass refills the slabs of the first one
+                return run_protocol(Protocol(p), arena_lines);
+            });
+
+        MappedLines mapped_lines(fname);
+        run_all_protocols("MappedLines", fname, n, st.st_size, mapped_lines);
+
+        FdLines fd_lines(fname);
+        run_all_protocols("FdLines", fname, n, st.st_size, fd_lines);
+
+        ReadAheadLines read_ahead_lines(fname);
+        run_all_protocols("ReadAheadLines", fname, n, st.st_size, read_ahead_lines);
+        const ReadAheadStats &stats = read_ahead_lines.stats();
+        if (stats.blocks > 0)
+            printf("ReadAheadLines: %llu blocks, consumer stalled on %llu, reading thread stalled on %llu\n", (unsigned long long)stats.blocks,
+               (unsigned long long)stats.consumer_stalls, (unsigned long long)stats.producer_stalls);
+
+        UringLines uring_lines(fname);
+        if (options.selected_container("UringLines") && !UringBlockSource(fname, 1, 1, true).uses_io_uring())
+            fprintf(stderr, "note: io_uring is not available, UringLines reads with pread\n");
+        run_all_protocols("UringLines", fname, n, st.st_size, uring_lines);
+
+        DirectLines direct_lines(fname);
+        DirectBlockSource probe(fname, DirectBlockSource::alignment, true);
+        probe.next_block(); // O_DIRECT can be refused by the first read
+        if (options.selected_container("DirectLines") && !probe.uses_direct_io())
+            fprintf(stderr, "note: O_DIRECT is not supported here, DirectLines drops the pages it read with posix_fadvise(DONTNEED)\n");
+        run_all_protocols("DirectLines", fname, n, st.st_size, direct_lines);
+
+        IndexedLines indexed_lines(fname, 4096, false);
+        run_all_protocols("IndexedLines", fname, n, st.st_size, indexed_lines);
+        const int64_t seeks = 1000;
+        run("IndexedLines", "seek", fname, seeks, 0, [&indexed_lines, seeks]() {
+            std::mt19937_64 rng(3);
+            uint64_t sum = 0;
+            for (int64_t i = 0; i < seeks; i++) {
+                auto it = indexed_lines.seek_line(int64_t(rng() % uint64_t(std::max(indexed_lines.count(), int64_t(1)))));
+                if (!it.empty())
+                    consume(sum, it.current());
+            }
+            return sum;
+        });
+
+        ReverseLines reverse_lines(fname);
+        run_all_protocols("ReverseLines", fname, n, st.st_size, reverse_lines);
+        const int64_t tail = std::min(n, int64_t(1000));
+        run("ReverseLines", "tail", fname, tail, 0, [&reverse_lines, tail]() {
+            uint64_t sum = 0;
+            int64_t left = tail;
+            reverse_lines.for_each([&sum, &left](std::string_view line) {
+                consume(sum, line);
+                return --left > 0 ? LoopControl::Continue : LoopControl::Break;
+            });
+            return sum;
+        });
+
+        // Generated lines hold commas but no quotes, so they split as CSV records of a few fields
+        Records records(FdLines(fname), ',');
+        run_all_protocols("Records", fname, n, st.st_size, records);
+        Records projected(FdLines(fname), ',', '"', {1});
+        run("Records", "project", fname, n, st.st_size, [&projected]() {
+            uint64_t sum = 0;
+            projected.for_each([&sum](Record record) {consume(sum, record[0]);});
+            return sum;
+        });
+
+        // A pattern which is rare in generated lines (about one line in 5000), as for a grep-style filter rejecting most lines
+        const char *pattern = "xyz";
+        run("Lines", "grep", fname, n, st.st_size, [&lines, pattern]() {
+            uint64_t sum = 0;
+            lines.for_each([&sum, pattern](const std::string &line) {
+                if (line.find(pattern) != std::string::npos)
+                    consume(sum, line);
+            });
+            return sum;
+        });
+        MatchingLines matching_lines(fname, {pattern});
+        run_all_protocols("MatchingLines", fname, n, st.st_size, matching_lines);
+
+        Utf8Validated<FdLines> validated_lines(fname);
+        run_all_protocols("Utf8Validated", fname, n, st.st_size, validated_lines);
+        Utf8Transcoded<FdLines> utf16_lines(fname);
+        run_all_protocols("Utf8Transcoded", fname, n, st.st_size, utf16_lines);
+
+        ParallelLines parallel_lines(fname, threads);
+        std::vector<Sum> sums(parallel_lines.threads());
+        run("ParallelLines", "unordered", fname, n, st.st_size, [&parallel_lines, &sums]() {
+            for (Sum &sum : sums)
+                sum.value = 0;
+            parallel_lines.for_each_unordered([&sums](std::string_view line) {consume(sums[ThreadPool::worker_index()].value, line);});
+            uint64_t sum = 0;
+            for (const Sum &s : sums)
+                sum += s.value;
+            return sum;
+        });
+        run("ParallelLines", "ordered", fname, n, st.st_size, [&parallel_lines]() {
+            uint64_t sum = 0;
+            parallel_lines.for_each_ordered([](std::string_view line) {return line.size();}, [&sum](size_t size) {consume(sum, size);});
+            return sum;
+        });
+    }
+
+    // Compressed (gzip or zstd) lines, decompressed on the reading thread of DecompressedLines, and on the thread splitting the lines for comparison
+    void compressed_lines(const char *fname)
+    {
+        struct stat st;
+        if (stat(fname, &st) != 0) {
+            perror(fname);
+            return;
+        }
+        DecompressedLines lines(fname);
+        if (Decompressor(fname).input_format() == Decompressor::Format::Unsupported)
+            fprintf(stderr, "note: %s is compressed in a format this build cannot decompress\n", fname);
+        int64_t n = 0;
+        lines.for_each([&n](std::string_view) {n++;});
+        run_all_protocols("DecompressedLines", fname, n, st.st_size, lines);
+
+        struct InlineSource // decompresses when the splitter asks for the next block
+        {
+            std::unique_ptr<Decompressor> decompressor;
+            std::unique_ptr<char[]> buffer;
+            size_t block_size;
+
+            std::string_view next_block()
+            {
+                ssize_t len = decompressor->read_block(buffer.get(), block_size);
+                return len > 0 ? std::string_view(buffer.get(), size_t(len)) : std::string_view();
+            }
+        };
+        run("DecompressedLines", "no_thread", fname, n, st.st_size, [fname]() {
+            uint64_t sum = 0;
+            const size_t block_size = 256 << 10;
+            for (LineSplitter<InlineSource> it(InlineSource{std::unique_ptr<Decompressor>(new Decompressor(fname)), std::unique_ptr<char[]>(new char[block_size]), block_size}, 1 << 20); !it.empty(); it.advance())
+                consume(sum, it.current());
+            return sum;
+        });
+    }
+
+    void dir(const char *dir_name)
+    {
+        Dir dir(dir_name, false, NameFilter());
+        int64_t n = 0;
+        dir.iterate([&n](const std::string &) {n++;});
+        run_all_protocols("Dir", dir_name, n, 0, dir);
+        GetdentsDir getdents_dir(dir_name, false, NameFilter());
+        run_all_protocols("GetdentsDir", dir_name, n, 0, getdents_dir);
+
+        DirWalk walk(dir_name, false, NameFilter());
+        int64_t entries = 0;
+        walk.for_each([&entries](const std::string &) {entries++;});
+        run_all_protocols("DirWalk", dir_name, entries, 0, walk);
+
+        StatDir stat_dir(dir_name, false, NameFilter(), StatSize), batched_stat_dir(dir_name, false, NameFilter(), StatSize, 256);
+        run("StatDir", "names", dir_name, n, 0, [&stat_dir]() {
+            uint64_t sum = 0;
+            stat_dir.for_each([&sum](const DirEntry &entry) {consume(sum, entry.name());});
+            return sum;
+        });
+        run("StatDir", "size", dir_name, n, 0, [&stat_dir]() {
+            uint64_t sum = 0;
+            stat_dir.for_each([&sum](const DirEntry &entry) {consume(sum, entry.stat().size);});
+            return sum;
+        });
+        run("StatDir", "size_batched", dir_name, n, 0, [&batched_stat_dir]() {
+            uint64_t sum = 0;
+            batched_stat_dir.for_each([&sum](const DirEntry &entry) {consume(sum, entry.stat().size);});
+            return sum;
+        });
+
+        ParallelDirWalk parallel_walk(dir_name, false, NameFilter(), SubtreeFilter(), threads);
+        std::vector<Sum> sums(parallel_walk.threads());
+        run("ParallelDirWalk", "unordered", dir_name, entries, 0, [&parallel_walk, &sums]() {
+            for (Sum &sum : sums)
+                sum.value = 0;
+            parallel_walk.for_each_unordered([&sums](const std::string &path) {consume(sums[ThreadPool::worker_index()].value, path);});
+            uint64_t sum = 0;
+            for (const Sum &s : sums)
+                sum += s.value;
+            return sum;
+        });
+    }
+
+    bool finish()
+    {
+        if (options.json_path && !write_json(options.json_path, "io", results))
+            return false;
+        return !alloc_regression;
+    }
+};
+
+static int usage(const char *argv0)
+{
+    fprintf(stderr, "Usage:\n"
+                    "  %s gen-lines FILE [--size BYTES] [--lengths fixed:N|uniform:MIN:MAX|exp:MEAN] [--seed N]\n"
+                    "      writes a file of about BYTES (K/M/G suffixes allowed, default 1G) with line lengths drawn from the given distribution (default uniform:0:160)\n"
+                    "  %s gen-dir DIR [--entries N] [--depth D] [--fanout F]\n"
+                    "      creates N files (default 1000000) in DIR and, for D > 0 (default 0), F subdirectories (default 8) recursively filled the same way\n"
+                    "  %s run [--lines FILE] [--compressed-lines GZ_OR_ZST_FILE] [--dir DIR] [--cache warm,cold] [--passes N] [--threads T] [options]\n"
+                    "      times every protocol of Lines, ReusedLines, ArenaLines, MappedLines, FdLines, ReadAheadLines, UringLines and DirectLines over FILE and of Dir and GetdentsDir over DIR and DirWalk over its tree, the sizes of the files of DIR through StatDir, lazily and in batches, with warm and/or cold page cache, N passes each (default 3),\n"
+                    "      the unordered and ordered loops of ParallelLines over FILE and the loop of ParallelDirWalk over the tree of DIR on T threads (default: one per core),\n"
+                    "      the protocols of IndexedLines as well as 1000 random `seek_line()` calls, and of ReverseLines as well as reading the last 1000 lines,\n"
+                    "      the protocols of Records splitting FILE as CSV, as well as a loop projecting its second column,\n"
+                    "      the protocols of MatchingLines searching FILE for a rare pattern, against a `std::getline()` then `find()` loop over Lines,\n"
+                    "      and the protocols of the lines of FdLines validated as UTF-8 (Utf8Validated) and transcoded to UTF-16 (Utf8Transcoded);\n"
+                    "      the protocols of DecompressedLines over GZ_OR_ZST_FILE, against decompressing on the thread splitting the lines\n"
+                    "%s", argv0, argv0, argv0, BenchOptions::usage());
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+        return usage(argv[0]);
+    std::string command = argv[1];
+
+    if (command == "gen-lines" && argc >= 3) {
+        int64_t size = int64_t(1) << 30;
+        uint64_t seed = 1;
+        const char *lengths_spec = "uniform:0:160";
+        for (int i = 3; i < argc; i++)
+            if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+                size = parse_size(argv[++i]);
+            else if (strcmp(argv[i], "--lengths") == 0 && i + 1 < argc)
+                lengths_spec = argv[++i];
+            else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+                seed = strtoull(argv[++i], nullptr, 10);
+            else
+                return usage(argv[0]);
+        LineLengths lengths(seed);
+        if (!lengths.parse(lengths_spec)) {
+            fprintf(stderr, "Bad line length distribution: %s\n", lengths_spec);
+            return 2;
+        }
+        return generate_lines(argv[2], size, lengths) ? 0 : 1;
+    }
+
+    if (command == "gen-dir" && argc >= 3) {
+        int64_t entries = 1'000'000;
+        int depth = 0, fanout = 8;
+        for (int i = 3; i < argc; i++)
+            if (strcmp(argv[i], "--entries") == 0 && i + 1 < argc)
+                entries = atoll(argv[++i]);
+            else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+                depth = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--fanout") == 0 && i + 1 < argc)
+                fanout = atoi(argv[++i]);
+            else
+                return usage(argv[0]);
+        int64_t total = 0;
+        if (!generate_dir(argv[2], entries, depth, fanout, total))
+            return 1;
+        printf("%s: %lld entries\n", argv[2], (long long)total);
+        return 0;
+    }
+
+    if (command == "run") {
+        BenchOptions options;
+        const char *lines_fname = nullptr, *compressed_fname = nullptr, *dir_name = nullptr;
+        std::vector<Cache> caches = {Cache::Warm, Cache::Cold};
+        int passes = 3;
+        unsigned threads = 0;
+        for (int i = 2; i < argc; i++) {
+            if (options.parse(argc, argv, i))
+                continue;
+            if (strcmp(argv[i], "--lines") == 0 && i + 1 < argc)
+                lines_fname = argv[++i];
+            else if (strcmp(argv[i], "--compressed-lines") == 0 && i + 1 < argc)
+                compressed_fname = argv[++i];
+            else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc)
+                dir_name = argv[++i];
+            else if (strcmp(argv[i], "--passes") == 0 && i + 1 < argc)
+                passes = std::max(atoi(argv[++i]), 1);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = (unsigned)std::max(atoi(argv[++i]), 0);
+            else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+                std::string list = argv[++i];
+                caches.clear();
+                if (BenchOptions::in_list(list, "warm"))
+                    caches.push_back(Cache::Warm);
+                if (BenchOptions::in_list(list, "cold"))
+                    caches.push_back(Cache::Cold);
+            }
+            else
+                return usage(argv[0]);
+        }
+        if (lines_fname == nullptr && compressed_fname == nullptr && dir_name == nullptr)
+            return usage(argv[0]);
+
+        Benchmark benchmark(options, caches, passes, threads);
+        print_result_header();
+        if (lines_fname)
+            benchmark.lines(lines_fname);
+        if (compressed_fname)
+            benchmark.compressed_lines(compressed_fname);
+        if (dir_name)
+            benchmark.dir(dir_name);
+        return benchmark.finish() ? 0 : 1;
+    }
+
+    return usage(argv[0]);
+}
@@ -0,0 +1,160 @@
+#include "bench.hpp"
+#include "array.hpp"
+#include "range.hpp"
+#include "linked_list.hpp"
+#include "iter11l_linked_list.hpp"
+
+const ssize_t max_array_length = 100'000'000;
+using BenchArray = Array<int, max_array_length>;
+
+class Benchmark
+{
+    BenchOptions options;
+    std::vector<BenchResult> results;
+    uint64_t expected_checksum = 0;
+    bool checksum_mismatch = false, alloc_regression = false;
+
+    // The result of the same container and protocol at the previous (smaller) size, so that allocations growing with `n` are caught below `max_setup_allocations` elements too
+    const BenchResult *previous_size(const char *container, const char *protocol) const
+    {
+        for (auto r = results.rbegin(); r != results.rend(); ++r)
+            if (r->container == container && r->protocol == protocol)
+                return &*r;
+        return nullptr;
+    }
+
+public:
+    Benchmark(const BenchOptions &options) : options(options) {}
+
+    template <typename Pass> void run(const char *container, const char *protocol, int64_t n, Pass &&pass, bool zero_alloc = true)
+    {
+        if (!options.selected_container(container) || !options.selected_protocol(protocol))
+            return;
+        BenchResult r = measure(container, protocol, n, pass, options);
+        if (r.checksum != expected_checksum) {
+            fprintf(stderr, "%s %s: checksum %llu, expected %llu\n", container, protocol, (unsigned long long)r.checksum, (unsigned long long)expected_checksum);
+            checksum_mismatch = true;
+        }
+        if (options.count_allocations && !count_allocations(r, pass, zero_alloc, previous_size(container, protocol)))
+            alloc_regression = true;
+        if (options.perf)
+            count_perf_events(r, pass, std::max(int64_t(1), 1'000'000 / n)); // at least a million elements, so that small collections are not dominated by counter setup
+        print_result(r);
+        results.push_back(std::move(r));
+    }
+
+    // `allocating_protocols` lists protocols that are expected to allocate per element
+    template <typename Collection> void run_all_protocols(const char *container, int64_t n, Collection &collection, const char *allocating_protocols = "")
+    {
+        for (int p = 0; p < (int)Protocol::COUNT; p++) {
+            const char *protocol = protocol_name(Protocol(p));
+            bool zero_alloc = *allocating_protocols == '\0' || !BenchOptions::in_list(allocating_protocols, protocol);
+            run(container, protocol, n, [&collection, p]() {return run_protocol(Protocol(p), collection);}, zero_alloc);
+        }
+    }
+
+    void sizes(int64_t min_n, int64_t max_n)
+    {
+        for (int64_t n = min_n; n <= max_n; n *= 10) {
+            expected_checksum = uint64_t(n) * uint64_t(n - 1) / 2; // every container holds 0, 1, ..., n-1
+
+            if (options.selected_container("Array")) {
+                std::unique_ptr<BenchArray> array(new BenchArray);
+                for (int64_t i = 0; i < n; i++)
+                    array->append(int(i));
+                run_all_protocols("Array", n, *array);
+                run("Array", "raw", n, [&array]() { // the loop `for_each()` should match
+                    uint64_t sum = 0;
+                    for (const int *p = array->begin(), *end = array->end(); p != end; p++)
+                        consume(sum, *p);
+                    return sum;
+                });
+            }
+
+            Range range(0, int(n));
+            run_all_protocols("Range", n, range);
+            run("Range", "raw", n, [n]() {
+                uint64_t sum = 0;
+                for (int i = 0; i < int(n); i++)
+                    consume(sum, i);
+                return sum;
+            });
+
+            if (options.selected_container("List")) {
+                List<int> list;
+                for (int64_t i = 0; i < n; i++)
+                    list.append(int(i));
+                run_all_protocols("List", n, list);
+            }
+
+            if (options.selected_container("List<string>")) {
+                List<std::string> list;
+                for (int64_t i = 0; i < n; i++)
+                    list.append(std::string(32, char('a' + i % 26))); // too long for the small string buffer
+                expected_checksum = uint64_t(n) * 32;
+                run_all_protocols("List<string>", n, list, "Rust"); // `RustIterator::next()` returns a copy
+                expected_checksum = uint64_t(n) * uint64_t(n - 1) / 2;
+            }
+
+            if (options.selected_container("LinkedList")) {
+                LinkedList<int> list;
+                for (int64_t i = 0; i < n; i++)
+                    list.append(int(i));
+                run("LinkedList", "C++", n, [&list]() { // through iter11l_adapter.hpp
+                    uint64_t sum = 0;
+                    for (auto &&el : list.iter())
+                        consume(sum, el);
+                    return sum;
+                });
+                run("LinkedList", "11l", n, [&list]() {
+                    uint64_t sum = 0;
+                    if (auto it = list.iter()) do {
+                        consume(sum, it->current());
+                    } while (it->advance());
+                    return sum;
+                });
+            }
+        }
+    }
+
+    bool finish()
+    {
+        if (options.json_path && !write_json(options.json_path, "protocols", results))
+            return false;
+        return !checksum_mismatch && !alloc_regression;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    int64_t min_n = 1000, max_n = max_array_length;
+
+    for (int i = 1; i < argc; i++) {
+        if (options.parse(argc, argv, i))
+            continue;
+        if (strcmp(argv[i], "--min-n") == 0 && i + 1 < argc)
+            min_n = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--max-n") == 0 && i + 1 < argc)
+            max_n = atoll(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [options]\n"
+                            "  --min-n N            smallest collection size (default 1000)\n"
+                            "  --max-n N            largest collection size (default %lld)\n"
+                            "%s"
+                            "Containers: Array, Range, List, List<string>, LinkedList\n", argv[0], (long long)max_array_length, BenchOptions::usage());
+            return 2;
+        }
+    }
+    if (min_n < 1 || max_n > max_array_length) {
+        fprintf(stderr, "Sizes must be within [1, %lld]\n", (long long)max_array_length);
+        return 2;
+    }
+    if (options.count_allocations && uint64_t(min_n) <= max_setup_allocations && min_n * 10 > max_n)
+        fprintf(stderr, "note: with a single size of %lld elements, --alloc cannot tell per-element allocations from setup ones (add a larger --max-n)\n", (long long)min_n);
+
+    Benchmark benchmark(options);
+    print_result_header();
+    benchmark.sizes(min_n, max_n);
+    return benchmark.finish() ? 0 : 1;
+}
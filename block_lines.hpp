@@ -0,0 +1,166 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "cursor_protocols.hpp"
+#include "UniqueHandle.hpp"
+#include "byte_scan.hpp"
+
+// Cursor over the lines of the blocks of a block source, which provides
+//     std::string_view next_block() - the next block of the input, empty at its end; a block stays valid until the next call
+// Lines inside a block are views into it, and only a line spanning blocks is copied, into a carry buffer.
+// A line longer than `max_line_length` is returned in pieces of that length (`partial()` tells that the line goes on), so the carry buffer never grows beyond it.
+template <typename BlockSource> class LineSplitter
+{
+    BlockSource source;
+    std::string_view block; // the rest of the current block after the current line
+    std::vector<char> carry;
+    size_t max_line_length;
+    std::string_view line;
+    bool has_line = false, is_partial = false;
+
+    // Ends the line after the next `len` bytes of the block, which are followed by `skip` bytes not belonging to it (the newline)
+    void take(size_t len, size_t skip)
+    {
+        if (carry.empty())
+            line = block.substr(0, len);
+        else {
+            carry.insert(carry.end(), block.data(), block.data() + len);
+            line = std::string_view(carry.data(), carry.size());
+        }
+        block.remove_prefix(len + skip);
+        has_line = true;
+    }
+
+    void advance_across_blocks()
+    {
+        carry.clear();
+        while (true) {
+            const char *nl = find_byte(block.data(), block.data() + block.size(), '\n');
+            size_t len = nl != nullptr ? size_t(nl - block.data()) : block.size();
+            if (len > max_line_length - carry.size()) {
+                take(max_line_length - carry.size(), 0);
+                is_partial = true;
+                return;
+            }
+            if (nl != nullptr) {
+                take(len, 1);
+                return;
+            }
+            carry.insert(carry.end(), block.begin(), block.end());
+            block = source.next_block();
+            if (block.empty()) { // end of input, after a last line without a newline if `carry` is not empty
+                line = std::string_view(carry.data(), carry.size());
+                has_line = !carry.empty();
+                return;
+            }
+        }
+    }
+
+public:
+    LineSplitter(BlockSource &&source, size_t max_line_length) : source(std::move(source)), max_line_length(std::max(max_line_length, size_t(1)))
+    {
+        block = this->source.next_block();
+        advance();
+    }
+
+    static constexpr bool stable_current = false; // a line is a view into a block or into the carry buffer
+
+    bool empty() const {return !has_line;}
+    std::string_view current() const {return line;}
+    bool partial() const {return is_partial;}
+
+    void advance()
+    {
+        is_partial = false;
+        const char *nl = find_byte(block.data(), block.data() + block.size(), '\n');
+        if (nl != nullptr && size_t(nl - block.data()) <= max_line_length) { // the line is inside the current block
+            line = block.substr(0, size_t(nl - block.data()));
+            block.remove_prefix(line.size() + 1);
+            has_line = true;
+            return;
+        }
+        advance_across_blocks();
+    }
+};
+
+// Block source reading a file from `offset` on with plain read(2) calls into one reused buffer
+class FdBlockSource
+{
+    UniqueHandle<int, -1> fd;
+    std::unique_ptr<char[]> buffer;
+    size_t block_size;
+
+public:
+    FdBlockSource(const char *fname, size_t block_size, int64_t offset = 0) : buffer(new char[block_size]), block_size(block_size)
+    {
+        if ((fd = open(fname, O_RDONLY | O_CLOEXEC)) == -1)
+            return;
+        if (offset > 0 && lseek(fd, (off_t)offset, SEEK_SET) != (off_t)offset) {
+            close(fd);
+            fd = -1;
+            return;
+        }
+        posix_fadvise(fd, offset, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    FdBlockSource(FdBlockSource &&) = default;
+    ~FdBlockSource()
+    {
+        if (fd != -1)
+            close(fd);
+    }
+
+    std::string_view next_block()
+    {
+        if (fd == -1)
+            return std::string_view();
+        ssize_t n;
+        do
+            n = read(fd, buffer.get(), block_size);
+        while (n < 0 && errno == EINTR);
+        return n > 0 ? std::string_view(buffer.get(), size_t(n)) : std::string_view();
+    }
+};
+
+// Block source reading a file from `offset` on with pread(2), through a descriptor it does not own, so that several sources can read parts of one file concurrently
+class PreadBlockSource
+{
+    int fd;
+    int64_t offset;
+    std::unique_ptr<char[]> buffer;
+    size_t block_size;
+
+public:
+    PreadBlockSource(int fd, int64_t offset, size_t block_size) : fd(fd), offset(offset), buffer(new char[block_size]), block_size(block_size) {}
+
+    std::string_view next_block()
+    {
+        ssize_t n;
+        do
+            n = pread(fd, buffer.get(), block_size, (off_t)offset);
+        while (n < 0 && errno == EINTR);
+        if (n <= 0)
+            return std::string_view();
+        offset += n;
+        return std::string_view(buffer.get(), size_t(n));
+    }
+};
+
+// Lines of a file read through a file descriptor in blocks of `block_size` bytes.
+// Unlike with `Lines`, an iterator holds no std::ifstream (nor its locale and per-character `std::getline()`), but just a descriptor and a buffer, and lines are views into that buffer.
+class FdLines : public CursorProtocols<FdLines>
+{
+    const char *fname;
+    size_t block_size, max_line_length;
+
+public:
+    FdLines(const char *fname, size_t block_size = 256 << 10, size_t max_line_length = 1 << 20) : fname(fname), block_size(std::max(block_size, size_t(1))), max_line_length(max_line_length) {}
+
+    using Cursor = LineSplitter<FdBlockSource>;
+    Cursor cursor() const {return Cursor(FdBlockSource(fname, block_size), max_line_length);}
+};
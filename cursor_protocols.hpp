@@ -0,0 +1,256 @@
+#pragma once
+#include "print_iterable.hpp"
+
+// Generates the C++, D, Python, Rust, Java, C# and 11l protocols (and `iterate()`/`for_each()`) from a single cursor.
+// A cursor is positioned on the first element, if any, when constructed, and provides:
+//     bool empty() const  - no element to be read
+//     current()           - the element the cursor is positioned on
+//     void advance()      - move to the next element (only called when not empty)
+// and optionally `void retreat()` (see `Retreats`).
+// A container derives from `CursorProtocols<Container>` and defines `cursor() const`; all protocol objects then wrap a cursor, which keeps their loops as tight as the cursor itself.
+// Whether the element returned by `current()` stays valid after `advance()`, so that the value-returning protocols can step to the next element right away.
+// That is the case when it is returned by value, or when the cursor declares `static constexpr bool stable_current = true` (e.g. elements stored in a container); otherwise, as for a line buffer that is overwritten, the step is deferred to the following call.
+template <typename Cursor, typename = void> struct StableCurrent : std::bool_constant<!std::is_reference_v<decltype(std::declval<Cursor&>().current())>> {};
+template <typename Cursor> struct StableCurrent<Cursor, std::void_t<decltype(Cursor::stable_current)>> : std::bool_constant<Cursor::stable_current> {};
+
+// Whether the cursor can step back before its first element with `void retreat()` (only called on a cursor just constructed), so that the C# `MoveNext()` can start one step behind as a hand-written one does, instead of testing a flag on every call
+template <typename Cursor, typename = void> struct Retreats : std::false_type {};
+template <typename Cursor> struct Retreats<Cursor, std::void_t<decltype(std::declval<Cursor&>().retreat())>> : std::true_type {};
+
+// Without the hint, g++ threads the empty check of `iter11l()` into the loop of the caller when it compares the same values as `advance()` (as for a pointer pair), and the loop body gets duplicated
+#ifdef _MSC_VER
+#define CURSOR_UNLIKELY(cond) (cond)
+#else
+#define CURSOR_UNLIKELY(cond) __builtin_expect(bool(cond), 0)
+#endif
+
+template <typename Cursor> class CursorFacades
+{
+    static constexpr bool eager = StableCurrent<Cursor>::value;
+    static constexpr bool retreats = Retreats<Cursor>::value;
+
+public:
+    using Value = std::decay_t<decltype(std::declval<Cursor&>().current())>;
+
+    // C++
+    class CppSentinel
+    {
+    };
+
+    class CppIterator
+    {
+        Cursor cursor;
+
+    public:
+        CppIterator(Cursor &&cursor) : cursor(std::move(cursor)) {}
+
+        bool operator!=(CppSentinel) const {return !cursor.empty();}
+
+        decltype(auto) operator*() {return cursor.current();}
+        void operator++() {cursor.advance();}
+    };
+
+    // D
+    class DRange
+    {
+        Cursor cursor;
+
+    public:
+        DRange(Cursor &&cursor) : cursor(std::move(cursor)) {}
+
+        bool empty() {return cursor.empty();}
+        decltype(auto) front() {return cursor.current();}
+        void popFront() {cursor.advance();}
+    };
+
+    // Python
+    class PythonIterator
+    {
+        Cursor cursor;
+        bool started = false;
+
+    public:
+        PythonIterator(Cursor &&cursor) : cursor(std::move(cursor)) {}
+
+        decltype(auto) __next__()
+        {
+            if constexpr (eager) {
+                if (cursor.empty()) throw StopIteration();
+                decltype(auto) current = cursor.current();
+                cursor.advance();
+                return current;
+            }
+            else {
+                if (started) cursor.advance();
+                started = true;
+                if (cursor.empty()) throw StopIteration();
+                return cursor.current();
+            }
+        }
+    };
+
+    // Rust
+    class RustIterator
+    {
+        Cursor cursor;
+        bool started = false;
+
+    public:
+        RustIterator(Cursor &&cursor) : cursor(std::move(cursor)) {}
+
+        std::optional<Value> next()
+        {
+            if constexpr (eager) {
+                if (cursor.empty()) return std::nullopt;
+                std::optional<Value> current(cursor.current());
+                cursor.advance();
+                return current;
+            }
+            else {
+                if (started) cursor.advance();
+                started = true;
+                if (cursor.empty()) return std::nullopt;
+                return cursor.current();
+            }
+        }
+    };
+
+    // Java
+    class JavaIterator
+    {
+        Cursor cursor;
+        bool advance_pending = false;
+
+    public:
+        JavaIterator(Cursor &&cursor) : cursor(std::move(cursor)) {}
+
+        bool hasNext()
+        {
+            if (!eager && advance_pending) {
+                cursor.advance();
+                advance_pending = false;
+            }
+            return !cursor.empty();
+        }
+
+        decltype(auto) next()
+        {
+            if (!hasNext()) throw NoSuchElementException();
+            if constexpr (eager) {
+                decltype(auto) current = cursor.current();
+                cursor.advance();
+                return current;
+            }
+            else {
+                advance_pending = true;
+                return cursor.current();
+            }
+        }
+    };
+
+    // С#
+    class CsharpIterator
+    {
+        Cursor cursor;
+        bool started = false;
+
+    public:
+        CsharpIterator(Cursor &&cursor) : cursor(std::move(cursor))
+        {
+            if constexpr (retreats)
+                this->cursor.retreat();
+        }
+
+        bool MoveNext() // must not be called again after it returned false
+        {
+            if constexpr (!retreats) {
+                if (started) cursor.advance();
+                started = true;
+            }
+            else
+                cursor.advance();
+            return !cursor.empty();
+        }
+
+        decltype(auto) Current() {return cursor.current();}
+    };
+
+    // 11l
+    class Iterator11l
+    {
+        Cursor cursor;
+
+    public:
+        Iterator11l(Cursor &&cursor) : cursor(std::move(cursor)) {}
+
+        decltype(auto) current() {return cursor.current();}
+
+        bool advance() {cursor.advance(); return !cursor.empty();}
+    };
+};
+
+template <typename Derived> class CursorProtocols
+{
+    auto cursor() const {return static_cast<const Derived*>(this)->cursor();}
+
+    template <typename D = Derived> using Facades = CursorFacades<decltype(std::declval<const D&>().cursor())>;
+
+public:
+    template <typename D = Derived> void iterate(std::function<void(const typename Facades<D>::Value&)> yield_fn) const
+    {
+        for (auto c = cursor(); !c.empty(); c.advance())
+            yield_fn(c.current());
+    }
+
+    template <typename Fn> bool for_each(Fn &&fn) const
+    {
+        for (auto c = cursor(); !c.empty(); c.advance())
+            if (!yield_to(fn, c.current()))
+                return false;
+        return true;
+    }
+
+    // C++
+    auto begin() const {return typename Facades<>::CppIterator(cursor());}
+    auto end  () const {return typename Facades<>::CppSentinel();}
+
+    // D
+    auto range() const {return typename Facades<>::DRange(cursor());}
+
+    // Python
+    auto __iter__() const {return typename Facades<>::PythonIterator(cursor());}
+
+    // Rust
+    auto iter() const {return typename Facades<>::RustIterator(cursor());}
+
+    // Java
+    auto iterator() const {return typename Facades<>::JavaIterator(cursor());}
+
+    // С#
+    auto GetEnumerator() const {return typename Facades<>::CsharpIterator(cursor());}
+
+    // 11l
+    auto iter11l() const
+    {
+        auto c = cursor();
+        if (CURSOR_UNLIKELY(c.empty()))
+            return std::optional<typename Facades<>::Iterator11l>();
+        return std::optional<typename Facades<>::Iterator11l>(std::move(c));
+    }
+};
+
+// Exposes the protocols generated from `container.cursor()`, next to the hand-written ones of the container itself
+template <typename Container> class CursorView : public CursorProtocols<CursorView<Container>>
+{
+    const Container *container;
+
+public:
+    CursorView(const Container &container) : container(&container) {}
+
+    auto cursor() const {return container->cursor();}
+};
+
+template <typename Container> CursorView<Container> via_cursor(const Container &container)
+{
+    return CursorView<Container>(container);
+}
@@ -0,0 +1,16 @@
+#include "decompressed_lines.hpp"
+
+int main()
+{
+    // A file which is not compressed is read as is
+    print_iterable(DecompressedLines("lines.txt"));
+    std::cout << "\n\n";
+
+#if __has_include(<zlib.h>)
+    gzFile gz = gzopen("lines.txt.gz", "wb");
+    gzputs(gz, "first\nsecond\nthird\n");
+    gzclose(gz);
+    print_iterable(DecompressedLines("lines.txt.gz"));
+    remove("lines.txt.gz");
+#endif
+}
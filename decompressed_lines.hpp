@@ -0,0 +1,187 @@
+#pragma once
+#if __has_include(<zlib.h>)
+#include <zlib.h> // link with -lz
+#endif
+#if __has_include(<zstd.h>)
+#include <zstd.h> // link with -lzstd
+#endif
+#include "read_ahead_lines.hpp"
+
+// Reads a file as it would be after gunzip or unzstd, recognizing the format by its magic bytes; any other file is read as is.
+// gzip (and zlib) streams are decompressed with zlib, zstd frames with libzstd, each when its header is found at compile time; a file in a format it was built without yields nothing.
+// Concatenated gzip members and zstd frames (as written by `cat a.gz b.gz`, or by parallel compressors) are read one after the other. Decompression stops at corrupt data, after what was decoded before it.
+class Decompressor
+{
+public:
+    enum class Format {Plain, Gzip, Zstd, Unsupported};
+
+private:
+    UniqueHandle<int, -1> fd;
+    Format format = Format::Plain;
+    std::unique_ptr<char[]> input;
+    size_t input_size;
+    const char *next_in = nullptr; // input not consumed yet, up to `input_end`
+    const char *input_end = nullptr;
+    bool at_end = false; // of the input, or of what can be decoded
+#if __has_include(<zlib.h>)
+    z_stream z = {};
+    bool z_initialized = false;
+#endif
+#if __has_include(<zstd.h>)
+    ZSTD_DStream *zstd = nullptr;
+#endif
+
+    // Reads more input once all of it is consumed. Returns false at the end of the file.
+    bool refill()
+    {
+        if (next_in != input_end)
+            return true;
+        ssize_t n;
+        do
+            n = read(fd, input.get(), input_size);
+        while (n < 0 && errno == EINTR);
+        if (n <= 0)
+            return false;
+        next_in = input.get();
+        input_end = next_in + n;
+        return true;
+    }
+
+#if __has_include(<zlib.h>)
+    size_t inflate_into(char *out, size_t size)
+    {
+        z.next_out = (Bytef*)out;
+        z.avail_out = (uInt)size;
+        while (z.avail_out > 0 && refill()) {
+            z.next_in = (Bytef*)next_in;
+            z.avail_in = (uInt)(input_end - next_in);
+            int r = inflate(&z, Z_NO_FLUSH);
+            next_in = (const char*)z.next_in;
+            if (r == Z_STREAM_END) // the next member, if any, starts with a header of its own
+                inflateReset(&z);
+            else if (r != Z_OK && !(r == Z_BUF_ERROR && next_in == input_end)) {
+                at_end = true;
+                break;
+            }
+        }
+        return size - z.avail_out;
+    }
+#endif
+
+#if __has_include(<zstd.h>)
+    size_t decompress_zstd_into(char *out, size_t size)
+    {
+        ZSTD_outBuffer output = {out, size, 0};
+        while (output.pos < output.size && refill()) {
+            ZSTD_inBuffer in = {next_in, size_t(input_end - next_in), 0};
+            size_t r = ZSTD_decompressStream(zstd, &output, &in);
+            next_in += in.pos;
+            if (ZSTD_isError(r)) {
+                at_end = true;
+                break;
+            }
+        }
+        return output.pos;
+    }
+#endif
+
+public:
+    Decompressor(const char *fname, size_t input_size = 128 << 10) : input(new char[input_size]), input_size(input_size)
+    {
+        if ((fd = open(fname, O_RDONLY | O_CLOEXEC)) == -1) {
+            at_end = true;
+            return;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if (!refill())
+            return;
+        const unsigned char *magic = (const unsigned char*)next_in;
+        size_t len = size_t(input_end - next_in);
+        if (len >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+            format = Format::Unsupported;
+#if __has_include(<zlib.h>)
+            if (inflateInit2(&z, 15 + 32) == Z_OK) // 15 + 32: the largest window, and a gzip or zlib header detected
+                format = Format::Gzip, z_initialized = true;
+#endif
+        }
+        else if (len >= 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+            format = Format::Unsupported;
+#if __has_include(<zstd.h>)
+            if ((zstd = ZSTD_createDStream()) != nullptr)
+                format = Format::Zstd;
+#endif
+        }
+        if (format == Format::Unsupported)
+            at_end = true;
+    }
+    Decompressor(const Decompressor &) = delete;
+    void operator=(const Decompressor &) = delete;
+    ~Decompressor()
+    {
+#if __has_include(<zlib.h>)
+        if (z_initialized)
+            inflateEnd(&z);
+#endif
+#if __has_include(<zstd.h>)
+        ZSTD_freeDStream(zstd);
+#endif
+        if (fd != -1)
+            close(fd);
+    }
+
+    Format input_format() const {return format;}
+
+    // Fills `out` with up to `size` bytes of the decompressed data. Returns 0 at its end.
+    ssize_t read_block(char *out, size_t size)
+    {
+        if (at_end)
+            return 0;
+        switch (format) {
+        case Format::Plain:
+            if (next_in != input_end) { // what was read to look for a magic number
+                size_t n = std::min(size, size_t(input_end - next_in));
+                memcpy(out, next_in, n);
+                next_in += n;
+                return ssize_t(n);
+            }
+            ssize_t n;
+            do
+                n = read(fd, out, size);
+            while (n < 0 && errno == EINTR);
+            return n;
+#if __has_include(<zlib.h>)
+        case Format::Gzip:
+            return ssize_t(inflate_into(out, size));
+#endif
+#if __has_include(<zstd.h>)
+        case Format::Zstd:
+            return ssize_t(decompress_zstd_into(out, size));
+#endif
+        default:
+            return 0;
+        }
+    }
+};
+
+// Lines of a file which may be compressed with gzip or zstd (see `Decompressor`), like `zcat FILE` piped into `FdLines`, but without the pipe.
+// Decompression runs on the thread of a `ReadAheadBlockSource`, into a ring of `depth` blocks of `block_size` bytes, so that it overlaps the splitting and processing of the lines of the previous blocks.
+// Lines are views into these blocks: only a line spanning two blocks is copied.
+class DecompressedLines : public CursorProtocols<DecompressedLines>
+{
+    const char *fname;
+    size_t depth, block_size, max_line_length;
+    mutable ReadAheadStats counters;
+
+public:
+    DecompressedLines(const char *fname, size_t depth = 4, size_t block_size = 256 << 10, size_t max_line_length = 1 << 20)
+        : fname(fname), depth(std::max(depth, size_t(1))), block_size(std::max(block_size, size_t(1))), max_line_length(max_line_length) {}
+
+    const ReadAheadStats &stats() const {return counters;}
+
+    using Cursor = LineSplitter<ReadAheadBlockSource>;
+    Cursor cursor() const
+    {
+        std::shared_ptr<Decompressor> decompressor(new Decompressor(fname));
+        return Cursor(ReadAheadBlockSource([decompressor](char *buffer, size_t size) {return decompressor->read_block(buffer, size);}, depth, block_size, &counters), max_line_length);
+    }
+};
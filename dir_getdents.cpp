@@ -0,0 +1,8 @@
+#include "dir_getdents.hpp"
+
+int main()
+{
+    print_iterable(GetdentsDir("testdir", true, [](auto &&name) {return name.find(".txt") != name.npos;}));
+    std::cout << "\n\n";
+    print_iterable(GetdentsDir("testdir", false, NameFilter()));
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include "dir_iter_posix.hpp"
+#include "cursor_protocols.hpp"
+
+#ifdef SYS_getdents64
+// The record getdents64(2) fills its buffer with (declared by no libc header)
+struct linux_dirent64
+{
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1]; // NUL-terminated, within `d_reclen`
+};
+#endif
+
+// Reads the entries of a directory, given as a descriptor it owns, in batches: each getdents64(2) call fills a buffer of `buffer_size` bytes (about 40000 entries per MiB for short names), and entries are records walked in place.
+// readdir(3) makes the same system call, but into a buffer of 32 KiB in glibc, and every entry costs a library call. Where getdents64 does not exist, entries come from readdir(3).
+class DirentReader
+{
+    UniqueHandle<int, -1> fd;
+#ifdef SYS_getdents64
+    std::unique_ptr<char[]> buffer;
+    size_t buffer_size, pos = 0, len = 0;
+#else
+    UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+#endif
+
+public:
+#ifdef SYS_getdents64
+    using Entry = linux_dirent64;
+
+    DirentReader(int fd, size_t buffer_size) : buffer(new char[buffer_size]), buffer_size(buffer_size) {this->fd = fd;}
+#else
+    using Entry = dirent;
+
+    DirentReader(int fd, size_t)
+    {
+        if (fd != -1 && (dir_handle = fdopendir(fd)) == NULL)
+            close(fd);
+    }
+#endif
+    DirentReader(DirentReader &&) = default;
+    ~DirentReader()
+    {
+#ifdef SYS_getdents64
+        if (fd != -1)
+            close(fd);
+#else
+        if (dir_handle != NULL)
+            closedir(dir_handle);
+#endif
+    }
+
+    // Descriptor of the directory, for lookups relative to it
+    int dir_fd() const
+    {
+#ifdef SYS_getdents64
+        return fd;
+#else
+        return dir_handle != NULL ? dirfd(dir_handle) : -1;
+#endif
+    }
+
+    // The next entry, valid until the next call, or nullptr after the last one
+    const Entry *next()
+    {
+#ifdef SYS_getdents64
+        if (pos == len) {
+            if (fd == -1)
+                return nullptr;
+            long n;
+            do
+                n = syscall(SYS_getdents64, int(fd), buffer.get(), buffer_size);
+            while (n < 0 && errno == EINTR);
+            if (n <= 0)
+                return nullptr;
+            pos = 0;
+            len = size_t(n);
+        }
+        const Entry *de = (const Entry*)&buffer[pos];
+        pos += de->d_reclen;
+        return de;
+#else
+        return dir_handle != NULL ? readdir(dir_handle) : nullptr;
+#endif
+    }
+};
+
+// Entries of a directory as those of `Dir` (with the same filtering), read in batches by a `DirentReader` with a buffer of `buffer_size` bytes, with all protocols generated from a cursor.
+// Names are views of the `d_name` field of the records, valid until the next step, rather than copies into a string.
+class GetdentsDir : public CursorProtocols<GetdentsDir>
+{
+    Dir dir;
+    size_t buffer_size;
+
+public:
+    class Cursor
+    {
+        const Dir *dir;
+        DirentReader entries;
+        std::string_view name;
+        bool has_name = false;
+
+    public:
+        Cursor(const Dir *dir, size_t buffer_size) : dir(dir), entries(open(dir->dir_name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC), buffer_size) {advance();}
+
+        static constexpr bool stable_current = false; // a view into the buffer of entries
+
+        bool empty() const {return !has_name;}
+        std::string_view current() const {return name;}
+
+        void advance()
+        {
+            while (const DirentReader::Entry *de = entries.next())
+                if (dir->check_dirent(entries.dir_fd(), de)) {
+                    name = de->d_name;
+                    has_name = true;
+                    return;
+                }
+            has_name = false;
+        }
+    };
+
+    GetdentsDir(const std::string &dir_name, bool files_only, NameFilter name_filter, size_t buffer_size = 1 << 20)
+        : dir(dir_name, files_only, name_filter), buffer_size(std::max(buffer_size, size_t(1024))) {}
+
+    Cursor cursor() const {return Cursor(&dir, buffer_size);}
+};
@@ -0,0 +1,406 @@
+#pragma once
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <string.h>
+#include "print_iterable.hpp"
+#include "UniqueHandle.hpp"
+
+// The type of a directory entry, which is looked up with fstatat(2) in the directory open as `dir_fd` when it is DT_UNKNOWN: some filesystems (XFS without ftype, some NFS servers) return DT_UNKNOWN for every entry
+template <typename Dirent> unsigned char dirent_type(int dir_fd, const Dirent *de)
+{
+    if (de->d_type != DT_UNKNOWN)
+        return de->d_type;
+    struct stat st;
+    if (fstatat(dir_fd, de->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        return DT_UNKNOWN;
+    return IFTODT(st.st_mode);
+}
+
+using NameFilter = std::optional<std::function<bool(const std::string&)>>;
+
+class Dir
+{
+    std::string dir_name;
+    bool files_only;
+    NameFilter name_filter;
+
+    friend class GetdentsDir;
+    friend class DirWalk;
+    friend class ParallelDirWalk;
+    friend class StatDir;
+
+    // Whether an entry of type `type` (DT_REG, DT_DIR...) named `name` is returned
+    bool check_entry(unsigned char type, const char *name, std::string *cur_name = nullptr) const
+    {
+        if (type == DT_REG || (type == DT_DIR && strcmp(name, ".") != 0 && strcmp(name, "..") != 0))
+            if (!files_only || type == DT_REG) {
+                if (name_filter && !(*name_filter)(name))
+                    return false;
+                if (cur_name)
+                    *cur_name = name;
+                return true;
+            }
+        return false;
+    }
+
+    // Also takes the `linux_dirent64` records of `GetdentsDir`, which have the same `d_type` and `d_name` fields
+    template <typename Dirent> bool check_dirent(int dir_fd, const Dirent *de, std::string *cur_name = nullptr) const
+    {
+        return check_entry(dirent_type(dir_fd, de), de->d_name, cur_name);
+    }
+
+public:
+    Dir(const std::string &dir_name, bool files_only, NameFilter name_filter) : dir_name(dir_name), files_only(files_only), name_filter(name_filter) {}
+
+    void iterate(std::function<void(const std::string&)> yield_fn = [](auto &&name) {std::cout << name << '\n';})
+    {
+        DIR *dir_handle = opendir(dir_name.c_str());
+        if (dir_handle == NULL) return;
+        while (dirent *de = readdir(dir_handle))
+            if (check_dirent(dirfd(dir_handle), de))
+                yield_fn(de->d_name);
+        closedir(dir_handle);
+    }
+
+    template <typename Fn> bool for_each(Fn &&fn)
+    {
+        DIR *dir_handle = opendir(dir_name.c_str());
+        if (dir_handle == NULL) return true;
+        std::string name; // unlike `iterate()`, the name buffer is reused
+        bool completed = true;
+        while (dirent *de = readdir(dir_handle))
+            if (check_dirent(dirfd(dir_handle), de, &name) && !yield_to(fn, std::as_const(name))) {
+                completed = false;
+                break;
+            }
+        closedir(dir_handle);
+        return completed;
+    }
+
+    // C++
+    class CppSentinel
+    {
+    };
+
+    class CppIterator
+    {
+        const Dir *dir;
+        UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+        std::string cur_name;
+        bool is_empty = true;
+
+        bool advance()
+        {
+            while (dirent *de = readdir(dir_handle))
+                if (dir->check_dirent(dirfd(dir_handle), de, &cur_name))
+                    return true;
+            return false;
+        }
+
+    public:
+        CppIterator(const Dir *dir) : dir(dir)
+        {
+            if ((dir_handle = opendir(dir->dir_name.c_str())) != NULL)
+                is_empty = !advance();
+        }
+        ~CppIterator()
+        {
+            if (dir_handle != NULL)
+                closedir(dir_handle);
+        }
+
+        bool operator!=(CppSentinel) const {return !is_empty;}
+
+        auto &operator*() {return cur_name;}
+        void operator++() {is_empty = !advance();}
+    };
+
+    CppIterator begin() const {return CppIterator(this);}
+    CppSentinel end  () const {return CppSentinel();}
+
+    // D
+    class DRange
+    {
+        const Dir *dir;
+        UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+        std::string cur_name;
+        bool is_empty = true;
+
+        bool advance()
+        {
+            while (dirent *de = readdir(dir_handle))
+                if (dir->check_dirent(dirfd(dir_handle), de, &cur_name))
+                    return true;
+            return false;
+        }
+
+    public:
+        DRange(const Dir *dir) : dir(dir)
+        {
+            if ((dir_handle = opendir(dir->dir_name.c_str())) != NULL)
+                is_empty = !advance();
+        }
+        ~DRange()
+        {
+            if (dir_handle != NULL)
+                closedir(dir_handle);
+        }
+
+        bool empty() {return is_empty;}
+        auto &front() {return cur_name;}
+        void popFront() {is_empty = !advance();}
+    };
+
+    DRange range() const {return DRange(this);}
+
+    // Python
+    class PythonIterator
+    {
+        const Dir *dir;
+        UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+        std::string cur_name;
+        bool first_call = true, empty = true;
+
+        bool advance()
+        {
+            while (dirent *de = readdir(dir_handle))
+                if (dir->check_dirent(dirfd(dir_handle), de, &cur_name))
+                    return true;
+            return false;
+        }
+
+    public:
+        PythonIterator(const Dir *dir) : dir(dir)
+        {
+            if ((dir_handle = opendir(dir->dir_name.c_str())) != NULL)
+                empty = !advance();
+        }
+        ~PythonIterator()
+        {
+            if (dir_handle != NULL)
+                closedir(dir_handle);
+        }
+
+        std::string __next__()
+        {
+            if (first_call) {
+                first_call = false;
+                if (empty)
+                    throw StopIteration();
+                else
+                    return cur_name;
+            }
+            if (advance())
+                return cur_name;
+            throw StopIteration();
+        }
+    };
+
+    auto __iter__() const {return PythonIterator(this);}
+
+    // Rust
+    class RustIterator
+    {
+        const Dir *dir;
+        UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+        std::string cur_name;
+        bool first_call = true, empty = true;
+
+        bool advance()
+        {
+            while (dirent *de = readdir(dir_handle))
+                if (dir->check_dirent(dirfd(dir_handle), de, &cur_name))
+                    return true;
+            return false;
+        }
+
+    public:
+        RustIterator(const Dir *dir) : dir(dir)
+        {
+            if ((dir_handle = opendir(dir->dir_name.c_str())) != NULL)
+                empty = !advance();
+        }
+        ~RustIterator()
+        {
+            if (dir_handle != NULL)
+                closedir(dir_handle);
+        }
+
+        std::optional<std::string> next()
+        {
+            if (first_call) {
+                first_call = false;
+                if (empty)
+                    return std::nullopt;
+                else
+                    return cur_name;
+            }
+            if (advance())
+                return cur_name;
+            return std::nullopt;
+        }
+    };
+
+    auto iter() const {return RustIterator(this);}
+
+    // Java
+    class JavaIterator
+    {
+        const Dir *dir;
+        UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+        std::string next_name;
+        bool has_next = false;
+
+        bool advance()
+        {
+            while (dirent *de = readdir(dir_handle))
+                if (dir->check_dirent(dirfd(dir_handle), de, &next_name))
+                    return true;
+            return false;
+        }
+
+    public:
+        JavaIterator(const Dir *dir) : dir(dir)
+        {
+            if ((dir_handle = opendir(dir->dir_name.c_str())) != NULL)
+                has_next = advance();
+        }
+        ~JavaIterator()
+        {
+            if (dir_handle != NULL)
+                closedir(dir_handle);
+        }
+
+        bool hasNext() {return has_next;}
+
+        std::string next()
+        {
+            if (!hasNext()) throw NoSuchElementException();
+            std::string cur_name = std::move(next_name);
+            has_next = advance();
+            return cur_name;
+        }
+    };
+
+    auto iterator() const {return JavaIterator(this);}
+
+    // С#
+    class CsharpIterator
+    {
+        const Dir *dir;
+        UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+        std::string cur_name;
+        bool empty = true, iteration_started = false;
+
+        bool advance()
+        {
+            while (dirent *de = readdir(dir_handle))
+                if (dir->check_dirent(dirfd(dir_handle), de, &cur_name))
+                    return true;
+            return false;
+        }
+
+    public:
+        CsharpIterator(const Dir *dir) : dir(dir)
+        {
+            if ((dir_handle = opendir(dir->dir_name.c_str())) != NULL)
+                empty = !advance();
+        }
+        ~CsharpIterator()
+        {
+            if (dir_handle != NULL)
+                closedir(dir_handle);
+        }
+
+        bool MoveNext()
+        {
+            if (!iteration_started) {
+                iteration_started = true;
+                return !empty;
+            }
+            return advance();
+        }
+
+        const std::string &Current() {return cur_name;}
+    };
+
+    auto GetEnumerator() const {return CsharpIterator(this);}
+
+    // 11l
+    class Iterator11l
+    {
+        const Dir *dir;
+        UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+        std::string cur_name;
+
+    public:
+        Iterator11l(const Dir *dir, bool &empty) : dir(dir)
+        {
+            if ((dir_handle = opendir(dir->dir_name.c_str())) != NULL)
+                empty = !advance();
+        }
+        Iterator11l(Iterator11l &&) = default;
+        ~Iterator11l()
+        {
+            if (dir_handle != NULL)
+                closedir(dir_handle);
+        }
+
+        const std::string &current() {return cur_name;}
+
+        bool advance()
+        {
+            while (dirent *de = readdir(dir_handle))
+                if (dir->check_dirent(dirfd(dir_handle), de, &cur_name))
+                    return true;
+            return false;
+        }
+    };
+
+    std::optional<Iterator11l> iter11l() const
+    {
+        bool empty = true;
+        Iterator11l r(this, empty);
+        if (empty)
+            return std::nullopt;
+        return r;
+    }
+
+    // Cursor (as in cursor_protocols.hpp), for adapters over any container of names, such as `Utf8Validated`
+    class Cursor
+    {
+        const Dir *dir;
+        UniqueHandle<DIR*, (DIR*)NULL> dir_handle;
+        std::string cur_name;
+        bool is_empty = true;
+
+    public:
+        Cursor(const Dir *dir) : dir(dir)
+        {
+            if ((dir_handle = opendir(dir->dir_name.c_str())) != NULL)
+                advance();
+        }
+        Cursor(Cursor &&) = default;
+        ~Cursor()
+        {
+            if (dir_handle != NULL)
+                closedir(dir_handle);
+        }
+
+        bool empty() const {return is_empty;}
+        const std::string &current() const {return cur_name;}
+
+        void advance()
+        {
+            is_empty = true;
+            while (dirent *de = readdir(dir_handle))
+                if (dir->check_dirent(dirfd(dir_handle), de, &cur_name)) {
+                    is_empty = false;
+                    return;
+                }
+        }
+    };
+
+    Cursor cursor() const {return Cursor(this);}
+};
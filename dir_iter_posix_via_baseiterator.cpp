@@ -37,6 +37,21 @@ public:
         closedir(dir_handle);
     }
 
+    template <typename Fn> bool for_each(Fn &&fn)
+    {
+        DIR *dir_handle = opendir(dir_name.c_str());
+        if (dir_handle == NULL) return true;
+        std::string name; // unlike `iterate()`, the name buffer is reused
+        bool completed = true;
+        while (dirent *de = readdir(dir_handle))
+            if (check_dirent(de, &name) && !yield_to(fn, std::as_const(name))) {
+                completed = false;
+                break;
+            }
+        closedir(dir_handle);
+        return completed;
+    }
+
     class BaseIterator
     {
         const Dir *dir;
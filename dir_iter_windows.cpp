@@ -40,6 +40,23 @@ public:
         FindClose(search_handle);
     }
 
+    template <typename Fn> bool for_each(Fn &&fn)
+    {
+        WIN32_FIND_DATAW file_data;
+        HANDLE search_handle = FindFirstFileW((dir_name + L"\\*.*").c_str(), &file_data);
+        if (search_handle == INVALID_HANDLE_VALUE) return true;
+        std::wstring name; // unlike `iterate()`, the name buffer is reused
+        bool completed = true;
+        do
+            if (check_filedata(file_data, &name) && !yield_to(fn, std::as_const(name))) {
+                completed = false;
+                break;
+            }
+        while (FindNextFileW(search_handle, &file_data));
+        FindClose(search_handle);
+        return completed;
+    }
+
     // C++
     class CppSentinel
     {
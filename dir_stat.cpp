@@ -0,0 +1,11 @@
+#include "dir_stat.hpp"
+
+int main()
+{
+    print_iterable(StatDir("testdir", true, [](auto &&name) {return name.find(".txt") != name.npos;}));
+    std::cout << "\n\n";
+    for (const DirEntry &entry : StatDir("testdir", false, NameFilter(), StatSize))
+        std::cout << entry.name() << (entry.is_dir() ? "/" : "") << ' ' << entry.stat().size << '\n';
+    std::cout << '\n';
+    StatDir("testdir", true, NameFilter(), StatSize | StatMtime, 64).for_each([](const DirEntry &entry) {std::cout << entry.name() << ' ' << entry.stat().size << ' ' << entry.stat().mtime.tv_sec << '\n';});
+}
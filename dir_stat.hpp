@@ -0,0 +1,243 @@
+#pragma once
+#include <vector>
+#include "dir_iter_posix.hpp"
+#include "uring_lines.hpp"
+#include "cursor_protocols.hpp"
+
+// Fields of the metadata of a directory entry, combined into a mask. The values are those of the STATX_* constants of statx(2).
+enum StatField : unsigned
+{
+    StatType = 0x1, StatMode = 0x2, StatNlink = 0x4, StatUid = 0x8, StatGid = 0x10, StatAtime = 0x20, StatMtime = 0x40, StatCtime = 0x80, StatIno = 0x100, StatSize = 0x200, StatBlocks = 0x400,
+    StatAll = 0x7FF
+};
+#ifdef STATX_SIZE
+static_assert(StatType == STATX_TYPE && StatMtime == STATX_MTIME && StatSize == STATX_SIZE && StatAll == STATX_BASIC_STATS, "StatField values must be those of statx(2)");
+#endif
+
+// Metadata of a directory entry, of which `fields` tells what was obtained: the fields requested which the filesystem provides (fstatat(2) provides all of them), or none if the entry is gone
+struct EntryStat
+{
+    unsigned fields = 0;
+    unsigned mode = 0; // type and permissions, as `st_mode`
+    uint32_t nlink = 0, uid = 0, gid = 0;
+    uint64_t ino = 0, size = 0, blocks = 0; // `blocks` of 512 bytes
+    timespec atime = {}, mtime = {}, ctime = {};
+
+#ifdef STATX_SIZE
+    void assign(const struct statx &stx, unsigned requested)
+    {
+        fields = stx.stx_mask & requested;
+        mode = stx.stx_mode;
+        nlink = stx.stx_nlink;
+        uid = stx.stx_uid;
+        gid = stx.stx_gid;
+        ino = stx.stx_ino;
+        size = stx.stx_size;
+        blocks = stx.stx_blocks;
+        atime = {time_t(stx.stx_atime.tv_sec), long(stx.stx_atime.tv_nsec)};
+        mtime = {time_t(stx.stx_mtime.tv_sec), long(stx.stx_mtime.tv_nsec)};
+        ctime = {time_t(stx.stx_ctime.tv_sec), long(stx.stx_ctime.tv_nsec)};
+    }
+#endif
+
+    void assign(const struct stat &st)
+    {
+        fields = StatAll;
+        mode = st.st_mode;
+        nlink = uint32_t(st.st_nlink);
+        uid = st.st_uid;
+        gid = st.st_gid;
+        ino = st.st_ino;
+        size = uint64_t(st.st_size);
+        blocks = uint64_t(st.st_blocks);
+        atime = st.st_atim;
+        mtime = st.st_mtim;
+        ctime = st.st_ctim;
+    }
+};
+
+// Fetches the `fields` (a mask of `StatField`s) of the entry `name` of the directory open as `dir_fd` without following a symbolic link.
+// statx(2) lets the filesystem skip the other fields (e.g. NFS need not flush the writes to a file for its size if only its mode is asked); fstatat(2) is the fallback where statx is unavailable.
+inline void stat_entry(int dir_fd, const char *name, unsigned fields, EntryStat &st)
+{
+    st.fields = 0;
+#ifdef STATX_SIZE
+    struct statx stx;
+    if (statx(dir_fd, name, AT_SYMLINK_NOFOLLOW, fields, &stx) == 0) {
+        st.assign(stx, fields);
+        return;
+    }
+    if (errno != ENOSYS && errno != EPERM) // EPERM from the seccomp filters of some container runtimes, which predate statx
+        return;
+#endif
+    struct stat s;
+    if (fstatat(dir_fd, name, &s, AT_SYMLINK_NOFOLLOW) == 0)
+        st.assign(s);
+}
+
+// An entry of a `StatDir`. Its name and type come from the directory; its metadata is fetched (relative to the descriptor of the directory) on the first call of `stat()`, unless the batched mode of `StatDir` has fetched it already.
+// Entries share the ownership of the open directory with the cursor, so that a copy (as returned by the Python, Rust and Java protocols) can fetch its metadata after the cursor is gone: the directory is closed with the last of them.
+class DirEntry
+{
+    friend class StatDir;
+
+    std::shared_ptr<DIR> dir_handle;
+    std::string entry_name;
+    unsigned char entry_type = DT_UNKNOWN;
+    unsigned stat_fields = 0;
+    mutable EntryStat metadata;
+    mutable bool fetched = false;
+
+public:
+    const std::string &name() const {return entry_name;}
+    unsigned char type() const {return entry_type;} // DT_REG or DT_DIR
+    bool is_dir() const {return entry_type == DT_DIR;}
+
+    // The fields requested from the `StatDir` (`stat().fields` tells which ones were obtained)
+    const EntryStat &stat() const
+    {
+        if (!fetched) {
+            stat_entry(dirfd(dir_handle.get()), entry_name.c_str(), stat_fields, metadata);
+            fetched = true;
+        }
+        return metadata;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const DirEntry &entry) {return os << entry.entry_name;}
+};
+
+// Entries of a directory as those of `Dir` (with the same filtering), with their metadata of `stat_fields` (a mask of `StatField`s) fetched relative to the descriptor of the directory rather than by full path, and all protocols generated from a cursor.
+// With `batch_size` = 0, metadata is fetched lazily, by the first call of `stat()` on an entry, so that entries whose metadata is not looked at cost no system call.
+// Otherwise entries are read `batch_size` at a time, and the metadata of a whole batch is fetched at once: the statx(2) calls are in flight concurrently through io_uring (or else made one after another), which hides the latency of a network filesystem. With a warm cache on a local filesystem, where statx does not block, this costs more than the lazy mode.
+// An entry of type DT_UNKNOWN (see `dirent_type()`) is statted for its type, which fetches its metadata in the same call.
+class StatDir : public CursorProtocols<StatDir>
+{
+    Dir dir;
+    unsigned stat_fields;
+    size_t batch_size;
+
+public:
+    class Cursor
+    {
+        const Dir *dir;
+        unsigned stat_fields;
+        std::shared_ptr<DIR> dir_handle; // shared with the entries
+        std::vector<DirEntry> batch; // the first `count` are the entries read
+        size_t count = 0, pos = 0;
+        bool batched;
+#if defined(STATX_SIZE) && defined(IORING_OFF_SQ_RING) && defined(__NR_io_uring_setup)
+        std::unique_ptr<IoUring> ring;
+        std::vector<struct statx> results;
+        std::vector<int> status; // per entry of the batch, 1 while in flight, then the result
+#endif
+
+        // Fetches the metadata of all the entries of the batch, concurrently if possible
+        void fetch_batch()
+        {
+#if defined(STATX_SIZE) && defined(IORING_OFF_SQ_RING) && defined(__NR_io_uring_setup)
+            if (ring) {
+                std::fill(status.begin(), status.begin() + count, 1);
+                for (size_t i = 0; i < count; i++)
+                    ring->queue_statx(dirfd(dir_handle.get()), batch[i].entry_name.c_str(), AT_SYMLINK_NOFOLLOW, batch[i].stat_fields, &results[i], i);
+                for (size_t done = 0; done < count;) {
+                    if (!ring->enter(1)) { // io_uring is given up, and the entries not completed are statted below
+                        ring.reset();
+                        break;
+                    }
+                    ring->reap([&](uint64_t i, int32_t result) {
+                        status[i] = result;
+                        done++;
+                    });
+                }
+                for (size_t i = 0; i < count; i++)
+                    if (status[i] == 0) {
+                        batch[i].metadata.assign(results[i], batch[i].stat_fields);
+                        batch[i].fetched = true;
+                    }
+                    else if (status[i] == -ENOENT) { // gone, so no fields
+                        batch[i].metadata.fields = 0;
+                        batch[i].fetched = true;
+                    }
+            }
+#endif
+            for (size_t i = 0; i < count; i++) // without io_uring, or where it failed (e.g. no IORING_OP_STATX before Linux 5.6)
+                batch[i].stat();
+        }
+
+        // Reads the next entries of the batch, resolving the type of DT_UNKNOWN ones, and drops those the filter of `Dir` rejects
+        void read_batch()
+        {
+            pos = 0;
+            do {
+                count = 0;
+                while (count < batch.size()) {
+                    dirent *de = dir_handle != nullptr ? readdir(dir_handle.get()) : nullptr;
+                    if (de == nullptr)
+                        break;
+                    unsigned char type = de->d_type;
+                    if (type != DT_UNKNOWN && !dir->check_entry(type, de->d_name))
+                        continue;
+                    DirEntry &entry = batch[count++];
+                    if (entry.dir_handle != dir_handle) // set once per slot of the batch, rather than a reference count update per entry
+                        entry.dir_handle = dir_handle;
+                    entry.entry_name = de->d_name;
+                    entry.entry_type = type;
+                    entry.stat_fields = type == DT_UNKNOWN ? stat_fields | StatType : stat_fields;
+                    entry.fetched = false;
+                }
+                if (count == 0)
+                    return;
+                if (batched)
+                    fetch_batch();
+                size_t kept = 0;
+                for (size_t i = 0; i < count; i++) {
+                    DirEntry &entry = batch[i];
+                    if (entry.entry_type == DT_UNKNOWN) {
+                        const EntryStat &st = entry.stat();
+                        entry.entry_type = (st.fields & StatType) != 0 ? (unsigned char)IFTODT(st.mode) : (unsigned char)DT_UNKNOWN;
+                        if (!dir->check_entry(entry.entry_type, entry.entry_name.c_str()))
+                            continue;
+                    }
+                    if (kept != i)
+                        std::swap(batch[kept], entry);
+                    kept++;
+                }
+                count = kept;
+            } while (count == 0);
+        }
+
+    public:
+        Cursor(const StatDir *stat_dir) : dir(&stat_dir->dir), stat_fields(stat_dir->stat_fields), batch(std::max(stat_dir->batch_size, size_t(1))), batched(stat_dir->batch_size > 0)
+        {
+            if (DIR *handle = opendir(dir->dir_name.c_str()))
+                dir_handle.reset(handle, closedir);
+            else
+                return;
+#if defined(STATX_SIZE) && defined(IORING_OFF_SQ_RING) && defined(__NR_io_uring_setup)
+            if (batched) {
+                ring.reset(new IoUring);
+                if (ring->setup(unsigned(batch.size()))) {
+                    results.resize(batch.size());
+                    status.resize(batch.size());
+                }
+                else
+                    ring.reset();
+            }
+#endif
+            read_batch();
+        }
+        bool empty() const {return pos == count;}
+        const DirEntry &current() const {return batch[pos];}
+
+        void advance()
+        {
+            if (++pos == count)
+                read_batch();
+        }
+    };
+
+    StatDir(const std::string &dir_name, bool files_only, NameFilter name_filter, unsigned stat_fields = StatAll, size_t batch_size = 0)
+        : dir(dir_name, files_only, name_filter), stat_fields(stat_fields), batch_size(std::min(batch_size, size_t(4096))) {}
+
+    Cursor cursor() const {return Cursor(this);}
+};
@@ -0,0 +1,10 @@
+#include "dir_walk.hpp"
+
+int main()
+{
+    print_iterable(DirWalk("testdir", true, [](auto &&name) {return name.find(".txt") != name.npos;}));
+    std::cout << "\n\n";
+    print_iterable(DirWalk("testdir", false, NameFilter()));
+    std::cout << "\n\n";
+    print_iterable(DirWalk("testdir", false, NameFilter(), [](auto &&path) {return path == "subdir";}));
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+#include "dir_iter_posix.hpp"
+#include "cursor_protocols.hpp"
+
+using SubtreeFilter = std::optional<std::function<bool(const std::string&)>>;
+
+// Whether an entry of type `type` is a directory to descend into (neither "." nor "..")
+inline bool is_subdirectory(unsigned char type, const char *name)
+{
+    return type == DT_DIR && strcmp(name, ".") != 0 && strcmp(name, "..") != 0;
+}
+
+// Entries of a directory tree, in depth-first order (a directory before its contents), as paths relative to the root `dir_name`, e.g. "subdir/first.txt".
+// Every subdirectory is opened with openat(2) relative to the descriptor of its parent, so no full path is resolved per level; the walk keeps an explicit stack of open directories (one descriptor per level) instead of recursing.
+// `files_only` and `name_filter` select the entries returned, as for `Dir`, but do not stop the descent. A directory for which `prune(relative_path)` returns true is skipped with its whole subtree, without being opened. Symbolic links are not followed.
+class DirWalk : public CursorProtocols<DirWalk>
+{
+    Dir dir;
+    SubtreeFilter prune;
+
+public:
+    class Cursor
+    {
+        struct Level
+        {
+            DIR *handle;
+            size_t path_length; // of the relative path of this directory ("" for the root)
+        };
+
+        const DirWalk *walk;
+        std::vector<Level> stack;
+        std::string path; // relative path of the current entry
+        bool is_empty = true, descend_next = false;
+
+        void push(int fd, size_t path_length)
+        {
+            if (fd == -1)
+                return;
+            if (DIR *handle = fdopendir(fd))
+                stack.push_back(Level{handle, path_length});
+            else
+                close(fd);
+        }
+
+        // Opens the directory which is the current entry
+        void descend()
+        {
+            const char *name = path.c_str() + stack.back().path_length + (stack.back().path_length > 0);
+            push(openat(dirfd(stack.back().handle), name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC), path.size());
+        }
+
+        void find_next()
+        {
+            is_empty = true;
+            while (!stack.empty()) {
+                Level &top = stack.back();
+                dirent *de = readdir(top.handle);
+                if (de == nullptr) {
+                    closedir(top.handle);
+                    stack.pop_back();
+                    continue;
+                }
+                unsigned char type = dirent_type(dirfd(top.handle), de);
+                bool is_dir = is_subdirectory(type, de->d_name);
+                if (!is_dir && type != DT_REG)
+                    continue;
+                path.resize(top.path_length);
+                if (top.path_length > 0)
+                    path += '/';
+                path += de->d_name;
+                if (is_dir && walk->prune && (*walk->prune)(path))
+                    continue;
+                if (walk->dir.check_entry(type, de->d_name)) {
+                    is_empty = false;
+                    descend_next = is_dir;
+                    return;
+                }
+                if (is_dir)
+                    descend();
+            }
+        }
+
+    public:
+        Cursor(const DirWalk *walk) : walk(walk)
+        {
+            push(open(walk->dir.dir_name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC), 0);
+            find_next();
+        }
+        Cursor(Cursor &&) = default;
+        ~Cursor()
+        {
+            for (Level &level : stack)
+                closedir(level.handle);
+        }
+
+        bool empty() const {return is_empty;}
+        const std::string &current() const {return path;}
+
+        void advance()
+        {
+            if (descend_next) {
+                descend_next = false;
+                descend();
+            }
+            find_next();
+        }
+    };
+
+    DirWalk(const std::string &dir_name, bool files_only, NameFilter name_filter, SubtreeFilter prune = SubtreeFilter()) : dir(dir_name, files_only, name_filter), prune(prune) {}
+
+    Cursor cursor() const {return Cursor(this);}
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <new>
+#include "block_lines.hpp"
+
+// Block source reading a file past the page cache: with O_DIRECT into a buffer aligned to `alignment`, in blocks of a multiple of it.
+// The length of every read is a multiple of `alignment` too, and the unaligned tail of the file simply comes back as a short read.
+// Where O_DIRECT is refused (at `open()`, or by the first read, as by filesystems that accept the flag but not the I/O), or `use_direct_io` is false, the file is read through the page cache, and the pages of every block are dropped with posix_fadvise(DONTNEED) right after it has been copied into the buffer.
+// DONTNEED also drops pages that were cached before the scan, so only O_DIRECT leaves the page cache really untouched.
+class DirectBlockSource
+{
+    struct AlignedDelete
+    {
+        size_t alignment;
+        void operator()(char *p) const {operator delete[](p, std::align_val_t(alignment));}
+    };
+
+    UniqueHandle<int, -1> fd;
+    std::unique_ptr<char[], AlignedDelete> buffer;
+    size_t block_size;
+    int64_t offset = 0; // of the next block
+    bool direct = false, at_end = false;
+
+public:
+    static const size_t alignment = 4096; // covers the logical block size of common devices (STATX_DIOALIGN would tell the exact one on Linux 6.1+)
+
+    DirectBlockSource(const char *fname, size_t block_size, bool use_direct_io) : buffer(new (std::align_val_t(alignment)) char[block_size], AlignedDelete{alignment}), block_size(block_size)
+    {
+#ifdef O_DIRECT
+        if (use_direct_io && (fd = open(fname, O_RDONLY | O_CLOEXEC | O_DIRECT)) != -1) {
+            direct = true;
+            return;
+        }
+#endif
+        if ((fd = open(fname, O_RDONLY | O_CLOEXEC)) != -1)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    DirectBlockSource(DirectBlockSource &&) = default;
+    ~DirectBlockSource()
+    {
+        if (fd != -1)
+            close(fd);
+    }
+
+    bool uses_direct_io() const {return direct;}
+
+    std::string_view next_block()
+    {
+        if (fd == -1 || at_end)
+            return std::string_view();
+        ssize_t n;
+        while (true) {
+            n = pread(fd, buffer.get(), block_size, (off_t)offset);
+            if (n < 0 && errno == EINTR)
+                continue;
+#ifdef O_DIRECT
+            if (n < 0 && errno == EINVAL && direct) { // the filesystem does not support O_DIRECT after all
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+                direct = false;
+                continue;
+            }
+#endif
+            break;
+        }
+        if (n <= 0) {
+            at_end = true;
+            return std::string_view();
+        }
+        // With O_DIRECT, a read shorter than requested ends at the end of the file, unless it stopped at an aligned offset (and the next read goes on from there)
+        if (direct && size_t(n) % alignment != 0)
+            at_end = true;
+        if (!direct) // the previous block once more, as DONTNEED skips pages which were still being read ahead
+            posix_fadvise(fd, std::max(offset - int64_t(block_size), int64_t(0)), int64_t(block_size) + n, POSIX_FADV_DONTNEED);
+        offset += n;
+        return std::string_view(buffer.get(), size_t(n));
+    }
+};
+
+// Lines of a file read without filling the page cache (see `DirectBlockSource`), for one-pass scans over files much larger than the memory, which would otherwise evict the working set of everything else.
+// Iterating over it behaves as over `FdLines`.
+class DirectLines : public CursorProtocols<DirectLines>
+{
+    const char *fname;
+    size_t block_size, max_line_length;
+    bool use_direct_io;
+
+public:
+    DirectLines(const char *fname, size_t block_size = 1 << 20, size_t max_line_length = 1 << 20, bool use_direct_io = true)
+        : fname(fname), block_size(std::max((block_size + DirectBlockSource::alignment - 1) / DirectBlockSource::alignment, size_t(1)) * DirectBlockSource::alignment),
+          max_line_length(max_line_length), use_direct_io(use_direct_io) {}
+
+    using Cursor = LineSplitter<DirectBlockSource>;
+    Cursor cursor() const {return Cursor(DirectBlockSource(fname, block_size, use_direct_io), max_line_length);}
+};
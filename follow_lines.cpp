@@ -0,0 +1,22 @@
+#include <thread>
+#include <fstream>
+#include "follow_lines.hpp"
+
+int main()
+{
+    // Prints the lines of lines.txt, then the ones appended to a log, until nothing is written for 200 ms
+    print_iterable(FollowLines("lines.txt", false, 200));
+    std::cout << "\n\n";
+
+    std::ofstream("follow.log") << "old\n";
+    FollowLines log("follow.log", true);
+    std::thread writer([&log] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::ofstream("follow.log", std::ios::app) << "appended 1\nappended 2\n";
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        log.stop();
+    });
+    log.for_each([](std::string_view line) {std::cout << line << '\n';}); // returns after `stop()`
+    writer.join();
+    remove("follow.log");
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include "block_lines.hpp"
+
+// Block source following a growing file like `tail -f`: at the end of the file, it sleeps in poll(2) on inotify until the file is modified, instead of ending.
+// A file truncated below what was read (as by `copytruncate`) is read again from its start. When the path is renamed or deleted and a new file appears under it (rotation), the old file is read to its end and the new one from its start.
+// If the file did not end with a newline at that point, a newline is inserted, so that its last line does not run into the first line of the new file.
+// The source ends when the `stop_fd` (an eventfd) becomes readable (checked before every read, as well as while waiting), or after `idle_timeout_ms` without new data (-1 for no timeout).
+class FollowBlockSource
+{
+    std::string path, name;
+    UniqueHandle<int, -1> fd, inotify_fd;
+    int file_wd = -1, dir_wd = -1, stop_fd, idle_timeout_ms;
+    std::unique_ptr<char[]> buffer;
+    size_t block_size;
+    int64_t offset = 0; // of the next read in the current file
+    dev_t dev = 0;
+    ino_t ino = 0;
+    char last_byte = '\n';
+    bool path_changed = false; // the path may name another file now
+    bool ended = false;
+
+    bool open_file()
+    {
+        struct stat st;
+        int new_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (new_fd == -1)
+            return false;
+        if (fstat(new_fd, &st) != 0) {
+            close(new_fd);
+            return false;
+        }
+        if (fd != -1)
+            close(fd);
+        if (file_wd != -1)
+            inotify_rm_watch(inotify_fd, file_wd);
+        fd = new_fd;
+        dev = st.st_dev;
+        ino = st.st_ino;
+        offset = 0;
+        file_wd = inotify_add_watch(inotify_fd, path.c_str(), IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+        return true;
+    }
+
+    // Sleeps until inotify reports something. Returns false when stopped or idle for too long.
+    bool wait()
+    {
+        pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+        int r = poll(fds, stop_fd != -1 ? 2 : 1, idle_timeout_ms);
+        if (r < 0)
+            return errno == EINTR;
+        if (r == 0 || fds[1].revents != 0)
+            return false;
+        alignas(inotify_event) char events[4096];
+        for (ssize_t n; (n = read(inotify_fd, events, sizeof(events))) > 0;)
+            for (char *p = events; p < events + n;) {
+                const inotify_event *e = (const inotify_event*)p;
+                if (e->wd == file_wd && (e->mask & (IN_MOVE_SELF | IN_DELETE_SELF)))
+                    path_changed = true;
+                if (e->wd == dir_wd && e->len > 0 && name == e->name)
+                    path_changed = true;
+                p += sizeof(inotify_event) + e->len;
+            }
+        return true;
+    }
+
+    // Whether `stop_fd` is readable, checked without blocking before every read: a file appended to faster than it is read never gets to `wait()`
+    bool stop_requested() const
+    {
+        pollfd pfd = {stop_fd, POLLIN, 0};
+        return stop_fd != -1 && poll(&pfd, 1, 0) > 0;
+    }
+
+    // Whether the path names a file other than the one being read
+    bool rotated() const
+    {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 && (st.st_dev != dev || st.st_ino != ino);
+    }
+
+public:
+    FollowBlockSource(const char *fname, size_t block_size, bool from_end, int stop_fd, int idle_timeout_ms)
+        : path(fname), stop_fd(stop_fd), idle_timeout_ms(idle_timeout_ms), buffer(new char[block_size]), block_size(block_size)
+    {
+        size_t slash = path.rfind('/');
+        name = slash == std::string::npos ? path : path.substr(slash + 1);
+        if ((inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1)
+            return;
+        // Watches are set up before reading, so that no modification after the last read can be missed
+        dir_wd = inotify_add_watch(inotify_fd, slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash).c_str(), IN_CREATE | IN_MOVED_TO);
+        if (open_file() && from_end)
+            offset = lseek(fd, 0, SEEK_END);
+    }
+    FollowBlockSource(FollowBlockSource &&) = default;
+    ~FollowBlockSource()
+    {
+        if (fd != -1)
+            close(fd);
+        if (inotify_fd != -1)
+            close(inotify_fd);
+    }
+
+    std::string_view next_block()
+    {
+        if (inotify_fd == -1 || ended)
+            return std::string_view();
+        while (true) {
+            if (stop_requested()) {
+                ended = true;
+                return std::string_view();
+            }
+            if (fd != -1) {
+                ssize_t n = pread(fd, buffer.get(), block_size, (off_t)offset);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n > 0) {
+                    offset += n;
+                    last_byte = buffer[size_t(n) - 1];
+                    return std::string_view(buffer.get(), size_t(n));
+                }
+                // At the end of the file
+                struct stat st;
+                bool truncated = fstat(fd, &st) == 0 && st.st_size < offset;
+                if (truncated || (path_changed && rotated())) {
+                    path_changed = false;
+                    if (truncated)
+                        offset = 0;
+                    else if (!open_file())
+                        continue;
+                    if (last_byte != '\n') {
+                        last_byte = '\n';
+                        return std::string_view("\n", 1);
+                    }
+                    continue;
+                }
+            }
+            else if (open_file()) // the file did not exist yet
+                continue;
+            if (!wait()) {
+                ended = true;
+                return std::string_view();
+            }
+        }
+    }
+};
+
+// Lines of a file that keeps growing, like `tail -f` (see `FollowBlockSource`); a line is yielded as soon as its newline is written.
+// Iterating over it does not end at the end of the file: positioning a cursor on its next line blocks until that line is complete, or until `stop()` is called (from another thread) or nothing was written for `idle_timeout_ms`.
+// With `from_end`, only lines written after the cursor is created are yielded.
+class FollowLines : public CursorProtocols<FollowLines>
+{
+    const char *fname;
+    bool from_end;
+    int idle_timeout_ms;
+    size_t block_size, max_line_length;
+    UniqueHandle<int, -1> stop_fd;
+
+public:
+    FollowLines(const char *fname, bool from_end = false, int idle_timeout_ms = -1, size_t block_size = 64 << 10, size_t max_line_length = 1 << 20)
+        : fname(fname), from_end(from_end), idle_timeout_ms(idle_timeout_ms), block_size(std::max(block_size, size_t(1))), max_line_length(max_line_length)
+    {
+        stop_fd = eventfd(0, EFD_CLOEXEC);
+    }
+    ~FollowLines()
+    {
+        if (stop_fd != -1)
+            close(stop_fd);
+    }
+
+    // Ends all iterations, present and future
+    void stop()
+    {
+        uint64_t one = 1;
+        if (stop_fd != -1 && write(stop_fd, &one, sizeof(one)) != sizeof(one))
+            perror("eventfd");
+    }
+
+    using Cursor = LineSplitter<FollowBlockSource>;
+    Cursor cursor() const {return Cursor(FollowBlockSource(fname, block_size, from_end, stop_fd, idle_timeout_ms), max_line_length);}
+};
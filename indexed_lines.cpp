@@ -0,0 +1,13 @@
+#include "line_index.hpp"
+
+int main()
+{
+    IndexedLines lines("lines.txt", 2); // writes the index to lines.txt.lidx
+    std::cout << lines.count() << " lines\n";
+
+    print_iterable(lines.lines(1, 3));
+    std::cout << "\n\n";
+
+    for (auto it = lines.seek_line(2); !it.empty(); it.advance())
+        std::cout << it.current() << '\n';
+}
@@ -1,3 +1,4 @@
+#pragma once
 #include <optional>
 
 class Sentinel11l
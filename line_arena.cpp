@@ -0,0 +1,18 @@
+#include "line_arena.hpp"
+
+int main()
+{
+    print_iterable(ReusedLines("lines.txt"));
+    std::cout << "\n\n";
+
+    // Lines collected through the Rust protocol stay valid until the arena is cleared
+    LineArena arena;
+    std::vector<std::string_view> kept;
+    auto it = ArenaLines(Lines("lines.txt"), arena).iter();
+    while (std::optional<std::string_view> line = it.next())
+        kept.push_back(*line);
+    for (auto i = kept.rbegin(); i != kept.rend(); ++i)
+        std::cout << *i << ' ';
+    std::cout << '\n';
+    arena.clear();
+}
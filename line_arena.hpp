@@ -0,0 +1,120 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <string.h>
+#include "read_lines.hpp"
+#include "cursor_protocols.hpp"
+
+// Lines whose value-returning protocols (Python, Rust, Java) return views of the line buffer of `Lines::Cursor` instead of a new std::string per line.
+// `std::getline()` reuses the capacity of that buffer, so once it has grown to the longest line, reading lines does not allocate at all. A view is valid until the next step; a caller keeping lines copies them, e.g. into a `LineArena`.
+class ReusedLines : public CursorProtocols<ReusedLines>
+{
+    const char *fname;
+
+public:
+    class Cursor
+    {
+        Lines::Cursor lines;
+
+    public:
+        Cursor(const char *fname) : lines(fname) {}
+
+        static constexpr bool stable_current = false; // a view into the line buffer
+
+        bool empty() const {return lines.empty();}
+        std::string_view current() {return lines.current();}
+        void advance() {lines.advance();}
+    };
+
+    ReusedLines(const char *fname) : fname(fname) {}
+
+    Cursor cursor() const {return Cursor(fname);}
+};
+
+// Bump allocator for lines (or any strings) kept by the caller: a line is copied at the end of the current slab of `slab_size` bytes (a longer line gets a slab of its own size), and all lines are freed at once.
+// `clear()` invalidates the lines but keeps the slabs, so that refilling a cleared arena does not allocate; the slabs themselves are only freed by the destructor.
+class LineArena
+{
+    std::vector<std::unique_ptr<char[]>> slabs;
+    std::vector<size_t> slab_sizes;
+    size_t slab_size, current = 0, used = 0; // bytes used of slab `current`
+
+public:
+    LineArena(size_t slab_size = 1 << 20) : slab_size(std::max(slab_size, size_t(1))) {}
+    LineArena(const LineArena &) = delete;
+    void operator=(const LineArena &) = delete;
+
+    std::string_view store(std::string_view line)
+    {
+        if (line.empty())
+            return std::string_view();
+        while (current < slabs.size() && slab_sizes[current] - used < line.size()) { // the rest of a slab which is too short for the line is left unused
+            current++;
+            used = 0;
+        }
+        if (current == slabs.size()) {
+            slab_sizes.push_back(std::max(slab_size, line.size()));
+            slabs.emplace_back(new char[slab_sizes.back()]);
+        }
+        char *p = &slabs[current][used];
+        memcpy(p, line.data(), line.size());
+        used += line.size();
+        return std::string_view(p, line.size());
+    }
+
+    void clear()
+    {
+        current = 0;
+        used = 0;
+    }
+
+    size_t capacity() const
+    {
+        size_t total = 0;
+        for (size_t size : slab_sizes)
+            total += size;
+        return total;
+    }
+};
+
+// Lines of any container of lines (`Lines`, `FdLines`...) copied into a `LineArena` as they are read, so that all protocols return views which stay valid until the arena is cleared, and collecting lines costs no allocation per line.
+template <typename LinesContainer> class ArenaLines : public CursorProtocols<ArenaLines<LinesContainer>>
+{
+    LinesContainer lines;
+    LineArena *arena;
+
+public:
+    class Cursor
+    {
+        decltype(std::declval<const LinesContainer&>().cursor()) lines;
+        LineArena *arena;
+        std::string_view line;
+        bool has_line = false;
+
+        void store()
+        {
+            if ((has_line = !lines.empty()))
+                line = arena->store(lines.current());
+        }
+
+    public:
+        Cursor(const ArenaLines &arena_lines) : lines(arena_lines.lines.cursor()), arena(arena_lines.arena) {store();}
+
+        static constexpr bool stable_current = true; // lines live in the arena, so the value-returning protocols step right away
+
+        bool empty() const {return !has_line;}
+        std::string_view current() const {return line;}
+
+        void advance()
+        {
+            lines.advance();
+            store();
+        }
+    };
+
+    ArenaLines(LinesContainer lines, LineArena &arena) : lines(std::move(lines)), arena(&arena) {}
+
+    Cursor cursor() const {return Cursor(*this);}
+};
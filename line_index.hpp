@@ -0,0 +1,198 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <sys/stat.h>
+#include "block_lines.hpp"
+
+// Sparse index of the lines of a file: the offset of every `stride`-th line and the number of lines, built in one pass over the file.
+// It is persisted in a sidecar file (FILE.lidx), which is only reused while the size and modification time of FILE are those it was built for.
+// Lines are counted as by `std::getline()`: a last line without a newline counts, the empty remainder after a final newline does not.
+class LineIndex
+{
+    struct Header
+    {
+        char magic[8];
+        uint64_t stride, file_size, line_count, offset_count;
+        int64_t mtime_ns;
+    };
+    static constexpr char magic[8] = {'L', 'I', 'D', 'X', '1', 0, 0, 0};
+
+    static int64_t mtime_ns(const struct stat &st) {return int64_t(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;}
+
+public:
+    size_t stride = 4096;
+    int64_t file_size = 0, file_mtime_ns = 0;
+    int64_t line_count = 0;
+    std::vector<int64_t> offsets; // offsets[k] is the offset of line k * stride
+
+    static std::string sidecar_name(const char *fname) {return std::string(fname) + ".lidx";}
+
+    bool build(const char *fname, const struct stat &st, size_t stride, size_t block_size = 1 << 20)
+    {
+        this->stride = stride;
+        file_size = st.st_size;
+        file_mtime_ns = mtime_ns(st);
+        line_count = 0;
+        offsets.assign(1, 0);
+        FdBlockSource source(fname, block_size);
+        int64_t block_offset = 0;
+        char last = '\n';
+        size_t to_next_entry = stride; // newlines until the line of the next entry starts
+        for (std::string_view block; !(block = source.next_block()).empty(); block_offset += int64_t(block.size())) {
+            const char *end = block.data() + block.size();
+            for (const char *p = block.data(); (p = find_byte(p, end, '\n')) != nullptr; p++) {
+                line_count++;
+                if (--to_next_entry == 0) {
+                    int64_t next = block_offset + (p + 1 - block.data());
+                    if (next < file_size) // not past a final newline, so that every entry but the first is within the file (see `valid()`)
+                        offsets.push_back(next);
+                    to_next_entry = stride;
+                }
+            }
+            last = block.back();
+        }
+        if (last != '\n')
+            line_count++;
+        if (block_offset != file_size) // the file changed while it was read
+            return false;
+        return true;
+    }
+
+    // Whether the offsets read from a sidecar can be those `build()` makes: the first is 0, and the others increase and are within the file
+    bool valid(int64_t file_size) const
+    {
+        if (offsets.empty() || offsets[0] != 0)
+            return false;
+        for (size_t k = 1; k < offsets.size(); k++)
+            if (offsets[k] <= offsets[k - 1] || offsets[k] >= file_size)
+                return false;
+        return true;
+    }
+
+    // A damaged sidecar (whose size and modification time still match) is rejected rather than trusted, so that the index gets rebuilt: the counts of its header must fit the file before anything is allocated for them.
+    bool load(const char *fname, const struct stat &st, size_t stride)
+    {
+        FILE *f = fopen(sidecar_name(fname).c_str(), "rb");
+        if (f == NULL)
+            return false;
+        Header h;
+        bool ok = fread(&h, sizeof(h), 1, f) == 1 && memcmp(h.magic, magic, sizeof(magic)) == 0 && h.stride == stride && stride > 0
+               && int64_t(h.file_size) == st.st_size && h.mtime_ns == mtime_ns(st) && h.line_count <= h.file_size
+               && h.offset_count >= 1 && h.offset_count <= h.line_count / stride + 1 && h.offset_count - 1 <= h.file_size / stride; // an entry every `stride` lines, of a byte at least
+        if (ok) {
+            offsets.resize(size_t(h.offset_count));
+            ok = fread(offsets.data(), sizeof(int64_t), offsets.size(), f) == offsets.size() && valid(st.st_size);
+        }
+        fclose(f);
+        if (!ok)
+            return false;
+        this->stride = stride;
+        file_size = st.st_size;
+        file_mtime_ns = h.mtime_ns;
+        line_count = int64_t(h.line_count);
+        return true;
+    }
+
+    // Writes the sidecar through a temporary file, so that a reader never sees a partial one
+    bool save(const char *fname) const
+    {
+        std::string name = sidecar_name(fname), tmp_name = name + ".tmp";
+        FILE *f = fopen(tmp_name.c_str(), "wb");
+        if (f == NULL)
+            return false;
+        Header h = {{}, stride, uint64_t(file_size), uint64_t(line_count), offsets.size(), file_mtime_ns};
+        memcpy(h.magic, magic, sizeof(magic));
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(offsets.data(), sizeof(int64_t), offsets.size(), f) == offsets.size();
+        ok = fclose(f) == 0 && ok && rename(tmp_name.c_str(), name.c_str()) == 0;
+        if (!ok)
+            remove(tmp_name.c_str());
+        return ok;
+    }
+};
+
+// Lines of a file with random access through a `LineIndex`: `count()` costs no I/O, and `seek_line(n)` and `lines(first, last)` start reading at the indexed line preceding line n, skipping fewer than `stride` lines, instead of rescanning the file from its start.
+// The index is loaded from its sidecar if it is valid, and built otherwise (and saved, if `persist`). Lines are split as by `FdLines`; pieces of a line longer than `max_line_length` count as one line.
+class IndexedLines : public CursorProtocols<IndexedLines>
+{
+    const char *fname;
+    size_t block_size, max_line_length;
+    LineIndex index;
+    bool sidecar_loaded = false;
+
+public:
+    // Positioned on the first line of a range [first, last) of lines
+    class Cursor
+    {
+        LineSplitter<FdBlockSource> lines;
+        int64_t remaining; // lines left in the range, including the current one
+
+    public:
+        Cursor(const char *fname, int64_t offset, int64_t skip, int64_t count, size_t block_size, size_t max_line_length)
+            : lines(FdBlockSource(fname, block_size, offset), max_line_length), remaining(count)
+        {
+            for (; skip > 0 && !lines.empty(); lines.advance())
+                if (!lines.partial())
+                    skip--;
+        }
+
+        static constexpr bool stable_current = false;
+
+        bool empty() const {return remaining <= 0 || lines.empty();}
+        std::string_view current() const {return lines.current();}
+        bool partial() const {return lines.partial();}
+
+        void advance()
+        {
+            if (!lines.partial())
+                remaining--;
+            lines.advance();
+        }
+    };
+
+    // Lines [first, last) of the file
+    class Range : public CursorProtocols<Range>
+    {
+        const IndexedLines *file;
+        int64_t first, last;
+
+    public:
+        Range(const IndexedLines *file, int64_t first, int64_t last) : file(file), first(first), last(last) {}
+
+        Cursor cursor() const {return file->range_cursor(first, last);}
+    };
+
+    IndexedLines(const char *fname, size_t stride = 4096, bool persist = true, size_t block_size = 256 << 10, size_t max_line_length = 1 << 20)
+        : fname(fname), block_size(std::max(block_size, size_t(1))), max_line_length(max_line_length)
+    {
+        stride = std::max(stride, size_t(1));
+        struct stat st;
+        if (stat(fname, &st) != 0)
+            return;
+        if ((sidecar_loaded = index.load(fname, st, stride)))
+            return;
+        if (index.build(fname, st, stride) && persist)
+            index.save(fname);
+    }
+
+    bool index_from_sidecar() const {return sidecar_loaded;}
+
+    int64_t count() const {return index.line_count;}
+
+    Cursor range_cursor(int64_t first, int64_t last) const
+    {
+        first = std::max(first, int64_t(0));
+        last = std::min(last, count());
+        int64_t entry = std::min(first / int64_t(index.stride), int64_t(index.offsets.size()) - 1);
+        if (first >= last || entry < 0)
+            return Cursor(fname, 0, 0, 0, 1, max_line_length);
+        return Cursor(fname, index.offsets[size_t(entry)], first - entry * int64_t(index.stride), last - first, block_size, max_line_length);
+    }
+
+    // A cursor positioned on line `n`, going on to the end of the file
+    Cursor seek_line(int64_t n) const {return range_cursor(n, count());}
+
+    Range lines(int64_t first, int64_t last) const {return Range(this, first, last);}
+
+    Cursor cursor() const {return seek_line(0);}
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include <string_view>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cursor_protocols.hpp"
+#include "UniqueHandle.hpp"
+
+// Lines of a file as `std::string_view`s pointing straight into a read-only mapping of it, so that no line is copied and no stream is involved.
+// The file is mapped in windows of `window_size` bytes, which lets files larger than the address space be read: when the next line crosses the end of the window, the window is moved to the page containing that line, and enlarged until the whole line fits.
+// As the window can move, a line is only valid until the next step of the iteration (like the line buffer of `Lines`).
+class MappedLines : public CursorProtocols<MappedLines>
+{
+    const char *fname;
+    size_t window_size;
+
+    static size_t page_size()
+    {
+        static const size_t size = (size_t)sysconf(_SC_PAGESIZE);
+        return size;
+    }
+
+public:
+    static constexpr size_t default_window_size = sizeof(void*) >= 8 ? size_t(1) << 30 : size_t(64) << 20;
+
+    MappedLines(const char *fname, size_t window_size = default_window_size) : fname(fname), window_size(std::max((window_size + page_size() - 1) & ~(page_size() - 1), page_size())) {}
+
+    class Cursor
+    {
+        UniqueHandle<int, -1> fd;
+        int64_t file_size = 0;
+        size_t window_size;
+        char *window = nullptr;
+        size_t window_len = 0;
+        int64_t window_offset = 0; // file offset of `window`
+        const char *pos = nullptr, *end = nullptr; // the rest of the window after the current line
+        std::string_view line;
+        bool has_line = false;
+
+        void unmap()
+        {
+            if (window != nullptr)
+                munmap(window, window_len);
+            window = nullptr;
+            pos = end = nullptr;
+        }
+
+        // `offset` must be a multiple of the page size
+        bool map(int64_t offset, size_t len)
+        {
+            unmap();
+            void *p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, (off_t)offset);
+            if (p == MAP_FAILED)
+                return false;
+            madvise(p, len, MADV_SEQUENTIAL);
+            window = (char*)p;
+            window_len = len;
+            window_offset = offset;
+            pos = window;
+            end = window + len;
+            return true;
+        }
+
+        bool window_reaches_file_end() const {return window_offset + (int64_t)window_len == file_size;}
+
+        // Moves the window to the page containing `pos`, enlarging it until it contains the newline ending the line at `pos` or reaches the end of the file. Returns that newline.
+        const char *remap()
+        {
+            int64_t line_offset = window_offset + (pos - window);
+            int64_t scanned_to = window_offset + (int64_t)window_len;
+            int64_t offset = line_offset & ~int64_t(page_size() - 1);
+            size_t len = window_size;
+            while (offset + (int64_t)len <= scanned_to) // the new window has to extend past what was already scanned
+                len *= 2;
+            for (;; len *= 2) {
+                len = (size_t)std::min<int64_t>((int64_t)len, file_size - offset);
+                if (!map(offset, len))
+                    return nullptr;
+                const char *from = window + (std::max(scanned_to, line_offset) - offset);
+                const char *nl = (const char*)memchr(from, '\n', end - from);
+                if (nl != nullptr || window_reaches_file_end()) {
+                    pos = window + (line_offset - offset);
+                    return nl;
+                }
+                scanned_to = offset + (int64_t)len;
+            }
+        }
+
+    public:
+        Cursor(const char *fname, size_t window_size) : window_size(window_size)
+        {
+            struct stat st;
+            if ((fd = open(fname, O_RDONLY | O_CLOEXEC)) != -1 && fstat(fd, &st) == 0 && st.st_size > 0) {
+                file_size = st.st_size;
+                map(0, (size_t)std::min<int64_t>((int64_t)window_size, file_size));
+            }
+            advance();
+        }
+        Cursor(Cursor &&other) : fd(std::move(other.fd)), file_size(other.file_size), window_size(other.window_size), window(other.window), window_len(other.window_len),
+                                 window_offset(other.window_offset), pos(other.pos), end(other.end), line(other.line), has_line(other.has_line)
+        {
+            other.window = nullptr;
+        }
+        ~Cursor()
+        {
+            unmap();
+            if (fd != -1)
+                close(fd);
+        }
+
+        static constexpr bool stable_current = false; // a line is unmapped when the window moves
+
+        bool empty() const {return !has_line;}
+        std::string_view current() const {return line;}
+
+        void advance()
+        {
+            const char *nl = pos != end ? (const char*)memchr(pos, '\n', end - pos) : nullptr;
+            if (nl == nullptr && window != nullptr && !window_reaches_file_end())
+                nl = remap();
+            if (pos == end) { // end of file, or a failed mapping
+                has_line = false;
+                return;
+            }
+            // Like `std::getline()`, a trailing newline does not start one more (empty) line
+            line = std::string_view(pos, (nl != nullptr ? nl : end) - pos);
+            pos = nl != nullptr ? nl + 1 : end;
+            has_line = true;
+        }
+    };
+
+    Cursor cursor() const {return Cursor(fname, window_size);}
+};
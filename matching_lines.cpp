@@ -0,0 +1,10 @@
+#include "matching_lines.hpp"
+
+int main()
+{
+    print_iterable(MatchingLines("lines.txt", {"ir"}));
+    std::cout << "\n\n";
+
+    // Lines containing any of the patterns
+    print_iterable(MatchingLines("lines.txt", {"con", "hi"}));
+}
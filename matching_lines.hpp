@@ -0,0 +1,119 @@
+#pragma once
+#include <string>
+#include "block_lines.hpp"
+
+// Lines of a file containing at least one of `patterns`, as `grep -F` finds them: the patterns are searched for (by `find_substring()`) in the raw blocks of the file, and line boundaries are only looked for around a hit.
+// The text between hits is never split into lines, so the cost of a scan in which most lines are rejected is that of the substring search, not of a newline search plus a search per line.
+// The read buffer holds `block_size` + `max_line_length` bytes; a line which does not fit in what remains of it is searched and returned in pieces of `max_line_length` bytes, and an occurrence across two pieces is missed.
+class MatchingLines : public CursorProtocols<MatchingLines>
+{
+    const char *fname;
+    std::vector<std::string> patterns;
+    size_t block_size, max_line_length;
+
+public:
+    class Cursor
+    {
+        UniqueHandle<int, -1> fd;
+        const std::vector<std::string> *patterns;
+        std::unique_ptr<char[]> buffer; // complete lines not searched yet, then the start of a line to be completed by the next read
+        size_t capacity, max_line_length;
+        size_t begin = 0, end = 0; // data of the buffer not searched yet
+        std::vector<const char*> hits; // per pattern, its next occurrence from `begin` on in the searchable part ending at `hits_limit` (nullptr if none, `stale` if not searched)
+        size_t hits_limit = SIZE_MAX;
+        std::string_view line;
+        bool has_line = false, at_eof = false;
+
+        static inline const char *const stale = reinterpret_cast<const char*>(1);
+
+        // End of the part of the buffer made of complete lines (or pieces), which can be searched
+        size_t searchable_end() const
+        {
+            if (at_eof)
+                return end;
+            if (const char *nl = find_last_byte(&buffer[begin], &buffer[end], '\n'))
+                return size_t(nl + 1 - buffer.get());
+            return end - begin >= max_line_length ? begin + max_line_length : begin;
+        }
+
+        // Moves the data not searched yet to the start of the buffer and reads more after it
+        void refill()
+        {
+            memmove(buffer.get(), &buffer[begin], end - begin);
+            end -= begin;
+            begin = 0;
+            ssize_t n;
+            do
+                n = read(fd, &buffer[end], capacity - end);
+            while (n < 0 && errno == EINTR);
+            if (n <= 0)
+                at_eof = true;
+            else
+                end += size_t(n);
+            hits_limit = SIZE_MAX;
+        }
+
+        void find_next()
+        {
+            has_line = false;
+            if (fd == -1)
+                return;
+            while (true) {
+                size_t limit = searchable_end();
+                if (limit != hits_limit) { // a new searchable part
+                    std::fill(hits.begin(), hits.end(), stale);
+                    hits_limit = limit;
+                }
+                const char *from = &buffer[begin], *to = &buffer[limit], *hit = nullptr;
+                for (size_t i = 0; i < hits.size() && from < to; i++) {
+                    if (hits[i] == stale || (hits[i] != nullptr && hits[i] < from)) // an occurrence before `from` was in a line already returned
+                        hits[i] = find_substring(from, to, (*patterns)[i]);
+                    if (hits[i] != nullptr && (hit == nullptr || hits[i] < hit))
+                        hit = hits[i];
+                }
+                if (hit != nullptr) {
+                    const char *nl = find_last_byte(from, hit, '\n'), *line_end = find_byte(hit, to, '\n');
+                    const char *line_begin = nl != nullptr ? nl + 1 : from;
+                    if (line_end == nullptr)
+                        line_end = to;
+                    line = std::string_view(line_begin, size_t(line_end - line_begin));
+                    begin = std::min(size_t(line_end - buffer.get()) + 1, limit);
+                    has_line = true;
+                    return;
+                }
+                begin = limit;
+                if (at_eof)
+                    return;
+                refill();
+            }
+        }
+
+    public:
+        Cursor(const char *fname, const std::vector<std::string> *patterns, size_t block_size, size_t max_line_length)
+            : patterns(patterns), buffer(new char[block_size + max_line_length]), capacity(block_size + max_line_length), max_line_length(max_line_length), hits(patterns->size(), stale)
+        {
+            if ((fd = open(fname, O_RDONLY | O_CLOEXEC)) == -1)
+                return;
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            refill();
+            find_next();
+        }
+        Cursor(Cursor &&) = default;
+        ~Cursor()
+        {
+            if (fd != -1)
+                close(fd);
+        }
+
+        static constexpr bool stable_current = false; // a line is a view into the buffer
+
+        bool empty() const {return !has_line;}
+        std::string_view current() const {return line;}
+        void advance() {find_next();}
+    };
+
+    MatchingLines(const char *fname, std::vector<std::string> patterns, size_t block_size = 256 << 10, size_t max_line_length = 1 << 20)
+        : fname(fname), patterns(std::move(patterns)), block_size(std::max(block_size, size_t(1))), max_line_length(std::max(max_line_length, size_t(1))) {}
+
+    Cursor cursor() const {return Cursor(fname, &patterns, block_size, max_line_length);}
+};
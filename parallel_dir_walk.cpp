@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <sys/stat.h>
+#include "parallel_dir_walk.hpp"
+
+int main()
+{
+    ParallelDirWalk walk("testdir", false, NameFilter());
+    std::mutex mutex;
+    std::vector<std::string> paths;
+    walk.for_each_unordered([&](const std::string &path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        paths.push_back(path);
+    });
+    std::sort(paths.begin(), paths.end());
+    for (const std::string &path : paths)
+        std::cout << path << ' ';
+    std::cout << '\n';
+
+    std::atomic<int> count{0};
+    ParallelDirWalk("testdir", true, [](auto &&name) {return name.find(".txt") != name.npos;}).for_each_unordered([&count](const std::string &) {count++;});
+    std::cout << count << " .txt files\n";
+
+    // A `LoopControl::Break` on one thread stops the others in the middle of their directories: 4 threads over 4 directories of 2000 files (in a temporary directory), stopped at the 10th entry once every thread is in a directory of its own
+    const int dirs = 4, files = 2000;
+    const char *tmp = getenv("TMPDIR");
+    std::string root = std::string(tmp != nullptr && *tmp != '\0' ? tmp : "/tmp") + "/parallel_dir_walk.XXXXXX";
+    if (mkdtemp(&root[0]) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    struct Cleanup // removes the tree however `main()` is left
+    {
+        const std::string &root;
+        ~Cleanup()
+        {
+            for (int d = 0; d < dirs; d++) {
+                std::string dir = root + "/d" + std::to_string(d);
+                for (int f = 0; f < files; f++)
+                    unlink((dir + "/f" + std::to_string(f)).c_str());
+                rmdir(dir.c_str());
+            }
+            rmdir(root.c_str());
+        }
+    } cleanup{root};
+    for (int d = 0; d < dirs; d++) {
+        std::string dir = root + "/d" + std::to_string(d);
+        mkdir(dir.c_str(), 0777);
+        for (int f = 0; f < files; f++)
+            close(open((dir + "/f" + std::to_string(f)).c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666));
+    }
+    std::atomic<int> calls{0};
+    std::atomic<unsigned> started{0};
+    bool completed = ParallelDirWalk(root, true, NameFilter(), SubtreeFilter(), dirs).for_each_unordered([&](const std::string &) {
+        static thread_local bool first = true;
+        if (first) {
+            first = false;
+            started++;
+            for (int i = 0; i < 1000 && started < dirs; i++)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return ++calls == 10 ? LoopControl::Break : LoopControl::Continue;
+    });
+    std::cout << "stopped: " << !completed << ", calls after the break: " << calls - 10 << (calls - 10 <= dirs - 1 ? " (at most one per other thread)" : " (too many)") << '\n';
+}
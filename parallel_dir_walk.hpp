@@ -0,0 +1,161 @@
+#pragma once
+#include <deque>
+#include "dir_walk.hpp"
+#include "thread_pool.hpp"
+
+// Entries of a directory tree, selected and named as by `DirWalk`, listed on a thread pool, for trees where the latency of reading directories (e.g. on network storage) rather than the CPU bounds a walk.
+// Every worker has a deque of the directories it has found and not read yet. It reads the last one it pushed (depth first, while its parent is still cached), and a worker whose deque is empty steals the oldest directory of another one, usually the root of the largest unexplored subtree.
+// A pending directory is only its relative path, opened with openat(2) from the descriptor of the root when read, so that the number of open descriptors is that of the threads however wide the tree is.
+class ParallelDirWalk
+{
+    Dir dir;
+    SubtreeFilter prune;
+    ThreadPool pool;
+
+    struct alignas(64) Worker // on cache lines of its own
+    {
+        std::mutex mutex;
+        std::deque<std::string> pending;
+    };
+
+    // State of one `for_each_unordered()` call
+    struct Walk
+    {
+        int root_fd;
+        std::vector<Worker> workers;
+        std::atomic<size_t> unfinished{0}; // directories pushed and not completely read yet
+        std::atomic<uint64_t> pushes{0};
+        std::atomic<unsigned> idle{0};
+        std::atomic<bool> stopped{false};
+        std::mutex idle_mutex;
+        std::condition_variable wake;
+
+        Walk(int root_fd, size_t workers) : root_fd(root_fd), workers(workers) {}
+
+        void notify_idle()
+        {
+            if (idle.load() > 0) {
+                {std::lock_guard<std::mutex> lock(idle_mutex);}
+                wake.notify_all();
+            }
+        }
+
+        void push(size_t self, const std::string &path)
+        {
+            unfinished++;
+            {
+                std::lock_guard<std::mutex> lock(workers[self].mutex);
+                workers[self].pending.push_back(path);
+            }
+            pushes++;
+            notify_idle();
+        }
+
+        // Takes the newest directory of worker `self`, or else the oldest one of another worker
+        bool take(size_t self, std::string &path)
+        {
+            for (size_t i = 0; i < workers.size(); i++) {
+                Worker &w = workers[(self + i) % workers.size()];
+                std::lock_guard<std::mutex> lock(w.mutex);
+                if (!w.pending.empty()) {
+                    path = std::move(i == 0 ? w.pending.back() : w.pending.front());
+                    i == 0 ? w.pending.pop_back() : w.pending.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void finish()
+        {
+            if (--unfinished == 0) {
+                {std::lock_guard<std::mutex> lock(idle_mutex);}
+                wake.notify_all();
+            }
+        }
+
+        void stop()
+        {
+            stopped = true;
+            {std::lock_guard<std::mutex> lock(idle_mutex);}
+            wake.notify_all();
+        }
+
+        // Waits until a directory may have been pushed since `seen` pushes, or the walk is over
+        void wait(uint64_t seen)
+        {
+            std::unique_lock<std::mutex> lock(idle_mutex);
+            idle++;
+            wake.wait(lock, [&] {return pushes.load() != seen || unfinished.load() == 0 || stopped.load();});
+            idle--;
+        }
+    };
+
+    // Calls `fn` for the selected entries of the directory `path`, and pushes its subdirectories
+    template <typename Fn> void read_directory(Walk &walk, size_t self, std::string &path, Fn &fn) const
+    {
+        int fd = openat(walk.root_fd, path.empty() ? "." : path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd == -1)
+            return;
+        DIR *handle = fdopendir(fd);
+        if (handle == NULL) {
+            close(fd);
+            return;
+        }
+        size_t length = path.size();
+        while (dirent *de = readdir(handle)) {
+            if (walk.stopped.load(std::memory_order_relaxed)) // `fn` returned `LoopControl::Break` on another thread
+                break;
+            unsigned char type = dirent_type(fd, de);
+            bool is_dir = is_subdirectory(type, de->d_name);
+            if (!is_dir && type != DT_REG)
+                continue;
+            path.resize(length);
+            if (length > 0)
+                path += '/';
+            path += de->d_name;
+            if (is_dir && prune && (*prune)(path))
+                continue;
+            if (is_dir)
+                walk.push(self, path);
+            if (dir.check_entry(type, de->d_name) && !yield_to(fn, std::as_const(path))) {
+                walk.stop();
+                break;
+            }
+        }
+        closedir(handle);
+    }
+
+public:
+    ParallelDirWalk(const std::string &dir_name, bool files_only, NameFilter name_filter, SubtreeFilter prune = SubtreeFilter(), unsigned threads = 0)
+        : dir(dir_name, files_only, name_filter), prune(prune), pool(threads) {}
+
+    unsigned threads() const {return pool.size();}
+
+    // Calls `fn(const std::string &relative_path)` for every entry, concurrently from all the pool threads (`ThreadPool::worker_index()` tells which one) and in no particular order; a directory is not necessarily listed before its contents.
+    // `fn` can stop the walk by returning `LoopControl::Break`, which the other threads notice at their next entry. Returns false if the walk was stopped.
+    template <typename Fn> bool for_each_unordered(Fn &&fn)
+    {
+        UniqueHandle<int, -1> root_fd;
+        if ((root_fd = open(dir.dir_name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)) == -1)
+            return true;
+        Walk walk(root_fd, pool.size());
+        walk.push(0, std::string());
+        pool.run(pool.size(), [&](size_t self) {
+            std::string path;
+            while (!walk.stopped.load(std::memory_order_relaxed)) {
+                uint64_t seen = walk.pushes.load();
+                if (walk.take(self, path)) {
+                    read_directory(walk, self, path, fn);
+                    walk.finish();
+                }
+                else if (walk.unfinished.load() == 0)
+                    return;
+                else
+                    walk.wait(seen);
+            }
+        });
+        close(root_fd);
+        return !walk.stopped;
+    }
+};
@@ -0,0 +1,12 @@
+#include "parallel_lines.hpp"
+
+int main()
+{
+    ParallelLines lines("lines.txt");
+    lines.for_each_ordered([](std::string_view line) {return std::string(line);}, [](const std::string &line) {std::cout << line << ' ';});
+    std::cout << '\n';
+
+    std::atomic<int> count{0};
+    lines.for_each_unordered([&count](std::string_view) {count++;});
+    std::cout << count << " lines\n";
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <sys/stat.h>
+#include "block_lines.hpp"
+#include "thread_pool.hpp"
+
+// Lines of a file processed on a thread pool. The file is split into chunks of `chunk_size` bytes, and a line belongs to the chunk it starts in, so every worker reads its chunk with pread(2) from the byte before it (to tell whether the chunk starts a line) up to the end of the last line starting in it.
+// Lines are split the same way as by `FdLines`, including lines longer than `max_line_length`, which come in pieces.
+class ParallelLines
+{
+    const char *fname;
+    size_t chunk_size, block_size, max_line_length;
+    ThreadPool pool;
+
+    // Calls `fn(line)` for the lines starting in [begin, end) of the file, while it returns true
+    template <typename Fn> void scan_chunk(int fd, int64_t begin, int64_t end, Fn &&fn) const
+    {
+        int64_t pos = begin > 0 ? begin - 1 : 0;
+        LineSplitter<PreadBlockSource> lines(PreadBlockSource(fd, pos, block_size), max_line_length);
+        if (begin > 0) // skip the end of a line starting in the previous chunk (an empty line if the chunk starts a line)
+            while (!lines.empty()) {
+                bool partial = lines.partial();
+                pos += lines.current().size() + !partial;
+                lines.advance();
+                if (!partial)
+                    break;
+            }
+        for (bool continues = false; !lines.empty() && (continues || pos < end); lines.advance()) {
+            continues = lines.partial();
+            pos += lines.current().size() + !continues;
+            if (!fn(lines.current()))
+                return;
+        }
+    }
+
+    // Opens the file and returns the number of chunks, or 0 if it cannot be read
+    size_t open_chunks(UniqueHandle<int, -1> &fd, int64_t &size) const
+    {
+        struct stat st;
+        if ((fd = open(fname, O_RDONLY | O_CLOEXEC)) == -1 || fstat(fd, &st) != 0)
+            return 0;
+        size = st.st_size;
+        return size_t((size + int64_t(chunk_size) - 1) / int64_t(chunk_size));
+    }
+
+    int64_t chunk_begin(size_t chunk) const {return int64_t(chunk) * int64_t(chunk_size);}
+
+public:
+    ParallelLines(const char *fname, unsigned threads = 0, size_t chunk_size = 16 << 20, size_t block_size = 256 << 10, size_t max_line_length = 1 << 20)
+        : fname(fname), chunk_size(std::max(chunk_size, size_t(1))), block_size(std::max(block_size, size_t(1))), max_line_length(max_line_length), pool(threads) {}
+
+    unsigned threads() const {return pool.size();}
+
+    // Calls `fn(std::string_view line)` for every line, concurrently from all the pool threads (`ThreadPool::worker_index()` tells which one) and in no particular order.
+    // `fn` can stop the loop by returning `LoopControl::Break`, which the other threads notice at their next line. Returns false if the loop was stopped.
+    template <typename Fn> bool for_each_unordered(Fn &&fn)
+    {
+        UniqueHandle<int, -1> fd;
+        int64_t size = 0;
+        size_t chunks = open_chunks(fd, size);
+        std::atomic<bool> stopped{false};
+        pool.run(chunks, [&](size_t chunk) {
+            if (stopped.load(std::memory_order_relaxed))
+                return;
+            scan_chunk(fd, chunk_begin(chunk), std::min(chunk_begin(chunk + 1), size), [&](std::string_view line) {
+                if (!yield_to(fn, line))
+                    stopped = true;
+                return !stopped.load(std::memory_order_relaxed);
+            });
+        });
+        if (fd != -1)
+            close(fd);
+        return !stopped;
+    }
+
+    // Calls `map(std::string_view line)` for every line concurrently from the pool threads, and `fn()` with its results in the order of the lines on the calling thread.
+    // The results of up to twice as many chunks as there are threads are kept, so they must not refer to the line (which is gone by then). `fn` can stop the loop by returning `LoopControl::Break`. Returns false if the loop was stopped.
+    template <typename Map, typename Fn> bool for_each_ordered(Map &&map, Fn &&fn)
+    {
+        using Result = std::decay_t<decltype(map(std::string_view()))>;
+        struct Slot
+        {
+            std::vector<Result> results;
+            bool ready = false;
+        };
+
+        UniqueHandle<int, -1> fd;
+        int64_t size = 0;
+        size_t chunks = open_chunks(fd, size);
+        const size_t window = 2 * size_t(pool.size());
+        std::vector<Slot> slots(window);
+        std::mutex mutex;
+        std::condition_variable changed;
+        size_t consumed = 0; // chunks whose results were passed to `fn`
+        bool stopped = false;
+
+        pool.start(chunks, [&](size_t chunk) {
+            Slot &slot = slots[chunk % window];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] {return chunk < consumed + window || stopped;}); // the slot is still in use by chunk - window
+                if (stopped)
+                    return;
+            }
+            slot.results.clear();
+            scan_chunk(fd, chunk_begin(chunk), std::min(chunk_begin(chunk + 1), size), [&](std::string_view line) {
+                slot.results.push_back(map(line));
+                return true;
+            });
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slot.ready = true;
+            }
+            changed.notify_all();
+        });
+
+        for (size_t chunk = 0; chunk < chunks && !stopped; chunk++) {
+            Slot &slot = slots[chunk % window];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] {return slot.ready;});
+            }
+            bool go_on = true;
+            for (size_t i = 0; i < slot.results.size() && go_on; i++)
+                go_on = yield_to(fn, std::move(slot.results[i]));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slot.ready = false;
+                consumed++;
+                stopped = !go_on;
+            }
+            changed.notify_all();
+        }
+        pool.wait();
+        if (fd != -1)
+            close(fd);
+        return !stopped;
+    }
+};
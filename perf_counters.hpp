@@ -0,0 +1,116 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdio.h>
+#include <errno.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware counters of the calling thread, read via perf_event_open(2).
+// Events are opened independently rather than as a group, so that the kernel can multiplex them on PMUs with few counters; counts are scaled by time_enabled/time_running accordingly.
+class PerfCounters
+{
+    struct Event
+    {
+        const char *name;
+        uint32_t type;
+        uint64_t config;
+        int fd;
+    };
+    std::vector<Event> events;
+    bool user_only = false; // kernel events are excluded when perf_event_paranoid does not allow counting them
+
+#ifdef __linux__
+    static constexpr uint64_t cache_miss(uint64_t cache) {return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);}
+
+    int open_event(uint32_t type, uint64_t config, bool exclude_kernel)
+    {
+        perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = exclude_kernel;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+
+public:
+    PerfCounters()
+    {
+#ifdef __linux__
+        const Event wanted[] = {
+            {"cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1},
+            {"instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1},
+            {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -1},
+            {"l1d_misses",    PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D), -1},
+            {"llc_misses",    PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL), -1},
+            {"dtlb_misses",   PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB), -1},
+        };
+        for (Event e : wanted) {
+            e.fd = open_event(e.type, e.config, user_only);
+            if (e.fd < 0 && !user_only && errno == EACCES) {
+                user_only = true;
+                // The events opened so far count kernel time too, so they are reopened the same way as the rest, and dropped if that fails
+                size_t reopened = 0;
+                for (Event &opened : events) {
+                    close(opened.fd);
+                    if ((opened.fd = open_event(opened.type, opened.config, true)) >= 0)
+                        events[reopened++] = opened;
+                }
+                events.resize(reopened);
+                e.fd = open_event(e.type, e.config, true);
+            }
+            if (e.fd >= 0)
+                events.push_back(e);
+        }
+#endif
+    }
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (Event &e : events)
+            close(e.fd);
+#endif
+    }
+    PerfCounters(const PerfCounters &) = delete;
+    void operator=(const PerfCounters &) = delete;
+
+    bool available() const {return !events.empty();}
+    bool kernel_excluded() const {return user_only;}
+
+    void start()
+    {
+#ifdef __linux__
+        for (Event &e : events)
+            ioctl(e.fd, PERF_EVENT_IOC_RESET, 0);
+        for (Event &e : events)
+            ioctl(e.fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    // Returns the name and count of every event that could be opened
+    std::vector<std::pair<std::string, double>> stop()
+    {
+        std::vector<std::pair<std::string, double>> counts;
+#ifdef __linux__
+        for (Event &e : events)
+            ioctl(e.fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (Event &e : events) {
+            uint64_t values[3]; // value, time_enabled, time_running
+            if (read(e.fd, values, sizeof(values)) != sizeof(values) || values[2] == 0)
+                continue;
+            counts.emplace_back(e.name, double(values[0]) * double(values[1]) / double(values[2]));
+        }
+#endif
+        return counts;
+    }
+};
@@ -1,12 +1,30 @@
+#pragma once
 #include <memory>
 #include <iostream>
 #include <optional>
 #include <functional>
+#include <type_traits>
+#include <utility>
 typedef ptrdiff_t ssize_t;
 
 class StopIteration {};
 class NoSuchElementException {};
 
+// What a callback passed to `for_each()` returns to continue or stop the loop. Callbacks returning void never stop it.
+// `for_each(fn)` of a container loops as its `iterate()` does, but takes `fn` as a template parameter rather than an std::function, so that it can be inlined, and returns false if `fn` stopped the loop.
+enum class LoopControl {Continue, Break};
+
+// Calls `fn` with the current element and tells whether the loop should go on
+template <typename Fn, typename Ty> inline bool yield_to(Fn &fn, Ty &&el)
+{
+    if constexpr (std::is_void_v<decltype(fn(std::forward<Ty>(el)))>) {
+        fn(std::forward<Ty>(el));
+        return true;
+    }
+    else
+        return fn(std::forward<Ty>(el)) != LoopControl::Break;
+}
+
 template <typename Collection> void print_iterable(const Collection &collection)
 {
 #ifdef USE_WCOUT
@@ -0,0 +1,118 @@
+#include "protocol_loops.hpp"
+#include "cursor_protocols.hpp"
+#include "array.hpp"
+#include "range.hpp"
+#include "linked_list.hpp"
+#include "iter11l_linked_list.hpp"
+
+// Every protocol loop over every container gets a function of its own, so that protocol_codesize.sh can find and measure it in the object file
+#ifdef _MSC_VER
+#define LOOP_FUNCTION extern "C" __declspec(noinline)
+#else
+#define LOOP_FUNCTION extern "C" __attribute__((noinline))
+#endif
+
+using LoopArray = Array<int, 1000>;
+using LoopList = List<int>;
+
+#define PROTOCOL_LOOPS(name, Container) \
+LOOP_FUNCTION uint64_t loop_##name##_cpp       (Container &c) {return run_cpp     (c);} \
+LOOP_FUNCTION uint64_t loop_##name##_d         (Container &c) {return run_d       (c);} \
+LOOP_FUNCTION uint64_t loop_##name##_python    (Container &c) {return run_python  (c);} \
+LOOP_FUNCTION uint64_t loop_##name##_rust      (Container &c) {return run_rust    (c);} \
+LOOP_FUNCTION uint64_t loop_##name##_java      (Container &c) {return run_java    (c);} \
+LOOP_FUNCTION uint64_t loop_##name##_csharp    (Container &c) {return run_csharp  (c);} \
+LOOP_FUNCTION uint64_t loop_##name##_11l       (Container &c) {return run_11l     (c);} \
+LOOP_FUNCTION uint64_t loop_##name##_iterate   (Container &c) {return run_iterate (c);} \
+LOOP_FUNCTION uint64_t loop_##name##_for_each  (Container &c) {return run_for_each(c);} \
+uint64_t (*const name##_loops[])(Container&) = {loop_##name##_cpp, loop_##name##_d, loop_##name##_python, loop_##name##_rust, \
+                                               loop_##name##_java, loop_##name##_csharp, loop_##name##_11l, loop_##name##_iterate, loop_##name##_for_each};
+
+PROTOCOL_LOOPS(array, LoopArray)
+PROTOCOL_LOOPS(range, Range)
+PROTOCOL_LOOPS(list, LoopList)
+PROTOCOL_LOOPS(array_via_cursor, CursorView<LoopArray>)
+PROTOCOL_LOOPS(range_via_cursor, CursorView<Range>)
+PROTOCOL_LOOPS(list_via_cursor, CursorView<LoopList>)
+
+// Hand-written loops without any iterator, for comparison
+LOOP_FUNCTION uint64_t loop_array_raw(LoopArray &array)
+{
+    uint64_t sum = 0;
+    for (const int *p = array.begin(), *end = array.end(); p != end; p++)
+        consume(sum, *p);
+    return sum;
+}
+
+LOOP_FUNCTION uint64_t loop_range_raw(int start, int end)
+{
+    uint64_t sum = 0;
+    for (int i = start; i < end; i++)
+        consume(sum, i);
+    return sum;
+}
+
+LOOP_FUNCTION uint64_t loop_linkedlist_cpp(LinkedList<int> &list)
+{
+    uint64_t sum = 0;
+    for (auto &&el : list.iter())
+        consume(sum, el);
+    return sum;
+}
+
+LOOP_FUNCTION uint64_t loop_linkedlist_11l(LinkedList<int> &list)
+{
+    uint64_t sum = 0;
+    if (auto it = list.iter()) do {
+        consume(sum, it->current());
+    } while (it->advance());
+    return sum;
+}
+
+// The report only needs the object file, but running the program checks that all the measured loops compute the same sum
+template <typename Container, size_t count> bool check(const char *name, Container &c, uint64_t (*const (&loops)[count])(Container&), uint64_t expected)
+{
+    bool ok = true;
+    for (size_t i = 0; i < count; i++)
+        if (loops[i](c) != expected) {
+            std::cout << name << ' ' << protocol_name(Protocol(i)) << ": wrong sum\n";
+            ok = false;
+        }
+    return ok;
+}
+
+int main()
+{
+    const int n = 1000;
+    const uint64_t expected = uint64_t(n) * (n - 1) / 2;
+
+    LoopArray array;
+    LoopList list;
+    LinkedList<int> linked_list;
+    for (int i = 0; i < n; i++) {
+        array.append(int(i));
+        list.append(int(i));
+        linked_list.append(int(i));
+    }
+    Range range(0, n);
+    CursorView<LoopArray> array_view(array);
+    CursorView<Range> range_view(range);
+    CursorView<LoopList> list_view(list);
+
+    bool ok = check("Array", array, array_loops, expected)
+            & check("Range", range, range_loops, expected)
+            & check("List",  list,  list_loops,  expected)
+            & check("via_cursor(Array)", array_view, array_via_cursor_loops, expected)
+            & check("via_cursor(Range)", range_view, range_via_cursor_loops, expected)
+            & check("via_cursor(List)",  list_view,  list_via_cursor_loops,  expected);
+    if (loop_array_raw(array) != expected || loop_range_raw(0, n) != expected) {
+        std::cout << "raw loop: wrong sum\n";
+        ok = false;
+    }
+    if (loop_linkedlist_cpp(linked_list) != expected || loop_linkedlist_11l(linked_list) != expected) {
+        std::cout << "LinkedList: wrong sum\n";
+        ok = false;
+    }
+    std::cout << (ok ? "all protocol loops agree\n" : "");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#!/bin/sh
+# Compiles protocol_codesize.cpp and reports, for every protocol loop function in it, the text size (including the .cold part), instruction, branch and call counts, and the length of its innermost loop.
+# A loop is flagged when its innermost loop is longer than that of the C++ begin()/end() loop over the same container (for Array this is the tight pointer loop), when it calls out from inside that loop, or when it has no loop at all.
+# Functions are named loop_<container>_<protocol>. Loops over protocols generated from a cursor (loop_<container>_via_cursor_<protocol>) are judged the same way, and the loop length of the hand-written protocol is shown next to them.
+#
+# Usage: ./protocol_codesize.sh [compiler flags, default -O2]
+# The compiler is taken from $CXX (default g++); x86-64 and AArch64 objdump output are understood.
+
+set -e
+CXX=${CXX:-g++}
+[ $# -eq 0 ] && set -- -O2
+obj=$(mktemp "${TMPDIR:-/tmp}/protocol_codesize.XXXXXX")
+trap 'rm -f "$obj"' EXIT
+
+$CXX -std=c++17 "$@" -c "$(dirname "$0")/protocol_codesize.cpp" -o "$obj"
+
+{ nm -S --defined-only "$obj"; echo "--- disassembly"; objdump -d --no-show-raw-insn "$obj"; } | awk '
+function hex(s,    i, v) {
+    v = 0
+    for (i = 1; i <= length(s); i++)
+        v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+    return v
+}
+
+function flush_function() {
+    if (fn == "")
+        return
+    base = fn
+    sub(/\.cold$/, "", base)
+    if (!(base in insns))
+        order[++nfunctions] = base
+    insns[base] += fn_insns
+    branches[base] += fn_branches
+    calls[base] += fn_calls
+    # innermost loop = shortest backward branch within the function (a branch back to a `ret` is an exit rather than a loop)
+    for (b = 1; b <= fn_nbackward; b++) {
+        len = 0; loop_calls = 0; exits = 0
+        for (i = 1; i <= fn_n; i++)
+            if (fn_addr[i] >= backward_target[b] && fn_addr[i] <= backward_from[b]) {
+                len++
+                if (fn_is_call[i]) loop_calls++
+                if (fn_is_ret[i]) exits++
+            }
+        if (exits == 0 && (!(base in loop_len) || len < loop_len[base])) {
+            loop_len[base] = len
+            loop_calls_of[base] = loop_calls
+        }
+    }
+    fn = ""
+}
+
+/^--- disassembly/ { disassembly = 1; next }
+
+!disassembly {
+    if ($4 ~ /^loop_/) {
+        name = $4
+        sub(/\.cold$/, "", name)
+        size[name] += hex($2)
+    }
+    next
+}
+
+/^[0-9a-f]+ <.*>:$/ {
+    flush_function()
+    name = $2
+    gsub(/[<>:]/, "", name)
+    if (name ~ /^loop_/) {
+        fn = name; fn_insns = fn_branches = fn_calls = fn_n = fn_nbackward = 0
+    }
+    next
+}
+
+fn != "" && /^ *[0-9a-f]+:\t/ {
+    split($0, parts, "\t")
+    addr = hex(substr(parts[1], match(parts[1], /[0-9a-f]+:/), RLENGTH - 1))
+    n = split(parts[2], op, " +")
+    mnemonic = op[1]
+    if (mnemonic ~ /^(nop|data16|cs|xchg)/ || mnemonic == "")
+        next
+    fn_insns++
+    fn_addr[++fn_n] = addr
+    fn_is_call[fn_n] = mnemonic ~ /^(call|bl|blr)$/
+    fn_is_ret[fn_n] = mnemonic ~ /^ret/
+    if (fn_is_call[fn_n])
+        fn_calls++
+    else if (mnemonic ~ /^(j|b\.|b$|cb|tb)/) {
+        fn_branches++
+        # backward branch to the same symbol
+        if (match(parts[2], /[0-9a-f]+ <[^>]+>/)) {
+            target_text = substr(parts[2], RSTART, RLENGTH)
+            split(target_text, t, " ")
+            target_sym = t[2]
+            gsub(/[<>]/, "", target_sym)
+            sub(/\+0x[0-9a-f]+$/, "", target_sym)
+            target = hex(t[1])
+            if (target_sym == fn && target <= addr) {
+                backward_target[++fn_nbackward] = target
+                backward_from[fn_nbackward] = addr
+            }
+        }
+    }
+}
+
+END {
+    flush_function()
+    printf "%-32s %6s %6s %9s %6s %11s %13s  %s\n", "function", "text", "insns", "branches", "calls", "loop insns", "hand-written", "verdict"
+    fflush()
+    for (k = 1; k <= nfunctions; k++) {
+        f = order[k]
+        split(f, name_parts, "_")
+        ref = "loop_" name_parts[2] "_cpp"
+        has_loop = f in loop_len
+        if (f == ref)
+            verdict = "reference"
+        else if (!has_loop)
+            verdict = "FLAG: no loop"
+        else if (loop_calls_of[f] > 0)
+            verdict = "FLAG: calls inside the loop"
+        else if ((ref in loop_len) && loop_len[f] > loop_len[ref])
+            verdict = "FLAG: loop longer than " ref " (" loop_len[ref] ")"
+        else
+            verdict = "ok"
+        hand_written = f
+        sub(/_via_cursor_/, "_", hand_written)
+        printf "%-32s %6d %6d %9d %6d %11s %13s  %s\n", f, size[f], insns[f], branches[f], calls[f], has_loop ? loop_len[f] : "-",
+               hand_written != f && (hand_written in loop_len) ? loop_len[hand_written] : "", verdict | "sort"
+    }
+}'
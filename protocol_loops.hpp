@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include <type_traits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "print_iterable.hpp"
+
+enum class Protocol {Cpp, D, Python, Rust, Java, Csharp, Iter11l, Iterate, ForEach, COUNT};
+
+inline const char *protocol_name(Protocol protocol)
+{
+    static const char *names[] = {"C++", "D", "Python", "Rust", "Java", "C#", "11l", "iterate", "for_each"};
+    return names[(int)protocol];
+}
+
+// Folds an element into the running checksum. The empty asm makes `sum` opaque to the optimizer, so a loop can be neither vectorized nor replaced by a closed form, and what gets measured is one protocol step per element.
+template <typename Ty> inline void consume(uint64_t &sum, const Ty &el)
+{
+    if constexpr (std::is_arithmetic_v<Ty>)
+        sum += (uint64_t)el;
+    else
+        sum += el.size();
+#ifdef _MSC_VER
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : "+r"(sum));
+#endif
+}
+
+// Same loops as in `print_iterable()`, but elements are consumed instead of printed
+template <typename Collection> uint64_t run_cpp(Collection &collection)
+{
+    uint64_t sum = 0;
+    for (auto it = collection.begin(); it != collection.end(); ++it)
+        consume(sum, *it);
+    return sum;
+}
+
+template <typename Collection> uint64_t run_d(Collection &collection)
+{
+    uint64_t sum = 0;
+    for (auto r = collection.range(); !r.empty(); r.popFront())
+        consume(sum, r.front());
+    return sum;
+}
+
+template <typename Collection> uint64_t run_python(Collection &collection)
+{
+    uint64_t sum = 0;
+    auto it = collection.__iter__();
+    while (true) {
+        try {
+            auto &&current = it.__next__();
+            consume(sum, current);
+        }
+        catch (StopIteration) {
+            break;
+        }
+    }
+    return sum;
+}
+
+template <typename Collection> uint64_t run_rust(Collection &collection)
+{
+    uint64_t sum = 0;
+    auto it = collection.iter();
+    while (auto current = it.next())
+        consume(sum, *current);
+    return sum;
+}
+
+template <typename Collection> uint64_t run_java(Collection &collection)
+{
+    uint64_t sum = 0;
+    auto it = collection.iterator();
+    while (it.hasNext()) {
+        auto &&current = it.next();
+        consume(sum, current);
+    }
+    return sum;
+}
+
+template <typename Collection> uint64_t run_csharp(Collection &collection)
+{
+    uint64_t sum = 0;
+    auto it = collection.GetEnumerator();
+    while (it.MoveNext())
+        consume(sum, it.Current());
+    return sum;
+}
+
+template <typename Collection> uint64_t run_11l(Collection &collection)
+{
+    uint64_t sum = 0;
+    if (auto it = collection.iter11l()) do {
+        consume(sum, it->current());
+    } while (it->advance());
+    return sum;
+}
+
+template <typename Collection> uint64_t run_iterate(Collection &collection)
+{
+    uint64_t sum = 0;
+    collection.iterate([&sum](auto &&el) {consume(sum, el);});
+    return sum;
+}
+
+template <typename Collection> uint64_t run_for_each(Collection &collection)
+{
+    uint64_t sum = 0;
+    collection.for_each([&sum](auto &&el) {consume(sum, el);});
+    return sum;
+}
+
+template <typename Collection> uint64_t run_protocol(Protocol protocol, Collection &collection)
+{
+    switch (protocol) {
+    case Protocol::Cpp:     return run_cpp     (collection);
+    case Protocol::D:       return run_d       (collection);
+    case Protocol::Python:  return run_python  (collection);
+    case Protocol::Rust:    return run_rust    (collection);
+    case Protocol::Java:    return run_java    (collection);
+    case Protocol::Csharp:  return run_csharp  (collection);
+    case Protocol::Iter11l: return run_11l     (collection);
+    case Protocol::Iterate: return run_iterate (collection);
+    case Protocol::ForEach: return run_for_each(collection);
+    case Protocol::COUNT:   break;
+    }
+    return 0;
+}
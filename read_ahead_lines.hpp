@@ -0,0 +1,168 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "block_lines.hpp"
+
+// Lets a thread wait for a condition on atomics that another thread changes without locking. The mutex is only taken when the waiter goes to sleep, and by the notifier only when somebody sleeps.
+class Event
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> waiting{false};
+
+public:
+    template <typename Ready> void wait(Ready &&ready)
+    {
+        for (int i = 0; i < 100; i++)
+            if (ready())
+                return;
+        std::unique_lock<std::mutex> lock(mutex);
+        waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in `notify()`: either the waiter sees the change, or the notifier sees `waiting`
+        while (!ready())
+            cv.wait(lock);
+        waiting.store(false, std::memory_order_relaxed);
+    }
+
+    // Must be called after the change that makes `ready()` true
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_one();
+        }
+    }
+};
+
+// Counters of all the iterations over a `ReadAheadLines`
+struct ReadAheadStats
+{
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<uint64_t> consumer_stalls{0}; // the next block was not read yet when the lines of the previous one were consumed (I/O bound)
+    std::atomic<uint64_t> producer_stalls{0}; // the ring was full when the reading thread had the next block to read (consumer bound)
+};
+
+// Block source whose blocks are read ahead by a thread of its own into a single-producer/single-consumer ring of `depth` blocks.
+// The ring indices are atomics, so neither side takes a lock while the other keeps up; a side only sleeps (on an `Event`) when the ring is empty or full.
+// Blocks are read from a file with read(2), or produced by a `read_block(buffer, size)` function, which returns the number of bytes it put into the buffer, 0 at the end and -1 on failure (as a decompressor does).
+class ReadAheadBlockSource
+{
+    struct Ring
+    {
+        UniqueHandle<int, -1> fd;
+        std::function<ssize_t(char*, size_t)> read_block;
+        size_t depth, block_size;
+        std::unique_ptr<char[]> buffers;
+        std::unique_ptr<size_t[]> lengths;
+        alignas(64) std::atomic<size_t> head{0}; // blocks released by the consumer
+        alignas(64) std::atomic<size_t> tail{0}; // blocks published by the producer, the last one being empty at the end of the file
+        std::atomic<bool> cancelled{false};
+        Event not_empty, not_full;
+        uint64_t consumer_stalls = 0, producer_stalls = 0;
+        std::thread producer;
+
+        Ring(size_t depth, size_t block_size) : depth(depth), block_size(block_size), buffers(new char[depth * block_size]), lengths(new size_t[depth]) {}
+
+        void produce()
+        {
+            for (size_t i = 0;; i++) {
+                if (i - head.load(std::memory_order_acquire) == depth) {
+                    producer_stalls++;
+                    not_full.wait([&] {return i - head.load(std::memory_order_acquire) < depth || cancelled.load(std::memory_order_relaxed);});
+                }
+                if (cancelled.load(std::memory_order_relaxed))
+                    return;
+                ssize_t n = read_block(&buffers[i % depth * block_size], block_size);
+                lengths[i % depth] = n > 0 ? size_t(n) : 0;
+                tail.store(i + 1, std::memory_order_release);
+                not_empty.notify();
+                if (n <= 0)
+                    return;
+            }
+        }
+    };
+    std::unique_ptr<Ring> ring;
+    ReadAheadStats *stats;
+    size_t next = 0; // block to be returned by `next_block()`
+    bool holding = false; // whether block `next - 1` is still in use
+
+public:
+    ReadAheadBlockSource(const char *fname, size_t depth, size_t block_size, ReadAheadStats *stats) : ring(new Ring(depth, block_size)), stats(stats)
+    {
+        if ((ring->fd = open(fname, O_RDONLY | O_CLOEXEC)) == -1)
+            return;
+        posix_fadvise(ring->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        ring->read_block = [fd = int(ring->fd)](char *buffer, size_t size) {
+            ssize_t n;
+            do
+                n = read(fd, buffer, size);
+            while (n < 0 && errno == EINTR);
+            return n;
+        };
+        ring->producer = std::thread(&Ring::produce, ring.get());
+    }
+    ReadAheadBlockSource(std::function<ssize_t(char*, size_t)> read_block, size_t depth, size_t block_size, ReadAheadStats *stats) : ring(new Ring(depth, block_size)), stats(stats)
+    {
+        ring->read_block = std::move(read_block);
+        ring->producer = std::thread(&Ring::produce, ring.get());
+    }
+    ReadAheadBlockSource(ReadAheadBlockSource &&) = default;
+    ~ReadAheadBlockSource()
+    {
+        if (ring == nullptr)
+            return;
+        if (ring->producer.joinable()) {
+            ring->cancelled.store(true);
+            ring->not_full.notify();
+            ring->producer.join();
+        }
+        if (ring->fd != -1)
+            close(ring->fd);
+        stats->blocks += next;
+        stats->consumer_stalls += ring->consumer_stalls;
+        stats->producer_stalls += ring->producer_stalls;
+    }
+
+    std::string_view next_block()
+    {
+        if (!ring->producer.joinable())
+            return std::string_view();
+        if (holding) {
+            ring->head.store(next, std::memory_order_release);
+            ring->not_full.notify();
+            holding = false;
+        }
+        if (ring->tail.load(std::memory_order_acquire) == next) {
+            ring->consumer_stalls++;
+            ring->not_empty.wait([&] {return ring->tail.load(std::memory_order_acquire) != next;});
+        }
+        size_t slot = next % ring->depth;
+        if (ring->lengths[slot] == 0) // end of file
+            return std::string_view();
+        next++;
+        holding = true;
+        return std::string_view(&ring->buffers[slot * ring->block_size], ring->lengths[slot]);
+    }
+};
+
+// Lines of a file read ahead by a thread while the previous ones are processed, in up to `depth` blocks of `block_size` bytes.
+// Iterating over it behaves as over `FdLines`, and `stats()` tells whether the iterations were bound by I/O or by the processing of the lines.
+class ReadAheadLines : public CursorProtocols<ReadAheadLines>
+{
+    const char *fname;
+    size_t depth, block_size, max_line_length;
+    mutable ReadAheadStats counters;
+
+public:
+    ReadAheadLines(const char *fname, size_t depth = 4, size_t block_size = 256 << 10, size_t max_line_length = 1 << 20)
+        : fname(fname), depth(std::max(depth, size_t(1))), block_size(std::max(block_size, size_t(1))), max_line_length(max_line_length) {}
+
+    const ReadAheadStats &stats() const {return counters;}
+
+    using Cursor = LineSplitter<ReadAheadBlockSource>;
+    Cursor cursor() const {return Cursor(ReadAheadBlockSource(fname, depth, block_size, &counters), max_line_length);}
+};
@@ -0,0 +1,11 @@
+#include "records.hpp"
+
+int main()
+{
+    print_iterable(Records(FdLines("records.csv")));
+    std::cout << "\n\n";
+
+    // Only the first and third columns, without storing the second one
+    for (Record record : Records(FdLines("records.csv"), ',', '"', {0, 2}))
+        std::cout << record[0] << ": " << record[1] << '\n';
+}
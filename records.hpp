@@ -0,0 +1,179 @@
+#pragma once
+#include <ostream>
+#include "block_lines.hpp"
+
+// The fields of one record, as views which stay valid until the cursor that returned it advances
+class Record
+{
+    const std::string_view *fields;
+    size_t count;
+
+public:
+    Record(const std::string_view *fields, size_t count) : fields(fields), count(count) {}
+
+    size_t size() const {return count;}
+    bool empty() const {return count == 0;}
+    std::string_view operator[](size_t i) const {return fields[i];}
+    const std::string_view *begin() const {return fields;}
+    const std::string_view *end  () const {return fields + count;}
+
+    friend std::ostream &operator<<(std::ostream &os, const Record &record)
+    {
+        for (size_t i = 0; i < record.count; i++)
+            os << (i > 0 ? "|" : "") << record.fields[i];
+        return os;
+    }
+};
+
+// Records of a delimited text file (CSV, TSV) read through any container of lines (`Lines`, `FdLines`, `MappedLines`...), whose fields are views into the line instead of strings.
+// A field starting with `quote` ends at the next `quote` not doubled, may contain delimiters and newlines (the record then spans several lines), and comes without its quotes; `quote` = 0 disables quoting, as in TSV. A CR before a newline is dropped.
+// Only a quoted field with doubled quotes, and a record spanning lines, are copied, into buffers of the cursor which are reused from one record to the next.
+// With `columns` (distinct), a record holds just these columns, in that order (an empty view for a column missing from the line): fields of other columns are skipped without being stored, and the line is not split beyond the last of them (only searched for quotes, which could continue the record on the next line).
+template <typename LinesContainer> class Records : public CursorProtocols<Records<LinesContainer>>
+{
+    LinesContainer lines;
+    char delimiter, quote;
+    std::vector<size_t> columns;
+
+public:
+    class Cursor
+    {
+        decltype(std::declval<const LinesContainer&>().cursor()) lines;
+        char delimiter, quote;
+        std::vector<int> slots; // with a projection, the position in the record of every column up to the last projected one, or -1
+        std::vector<std::string_view> fields;
+        std::string joined, unescaped;
+        bool has_record = false, lines_ended = false;
+
+        // Returns false when no further column is needed
+        bool set_field(size_t column, std::string_view value)
+        {
+            if (slots.empty()) {
+                fields.push_back(value);
+                return true;
+            }
+            if (slots[column] >= 0)
+                fields[size_t(slots[column])] = value;
+            return column + 1 < slots.size();
+        }
+
+        // Splits `text` into fields. Returns false if it ends inside a quoted field, unless `last`, which makes the rest of the text that field.
+        bool parse(std::string_view text, bool last)
+        {
+            const char *d;
+            if (slots.empty())
+                fields.clear();
+            else
+                std::fill(fields.begin(), fields.end(), std::string_view());
+            const char *p = text.data(), *end = p + text.size();
+            size_t column = 0;
+            if (quote == 0 || find_byte(p, end, quote) == nullptr) { // nothing quoted: the positions of all the delimiters come from one scan
+                bool more = for_each_byte(p, end, delimiter, [&](const char *q) {
+                    bool go_on = set_field(column++, std::string_view(p, size_t(q - p)));
+                    p = q + 1;
+                    return go_on;
+                });
+                if (more)
+                    set_field(column, std::string_view(p, size_t(end - p)));
+                return true;
+            }
+
+            unescaped.clear();
+            unescaped.reserve(text.size()); // unescaping never lengthens a field, so the views into it are not invalidated by a reallocation
+            for (bool needed = true;; p = d + 1) {
+                if (!needed && find_byte(p, end, quote) == nullptr) // the rest of the record is in this line, and not wanted
+                    return true;
+                std::string_view value;
+                if (p < end && *p == quote) {
+                    const char *segment = p + 1, *close;
+                    size_t from = unescaped.size();
+                    bool copied = false;
+                    while ((close = find_byte(segment, end, quote)) != nullptr && close + 1 < end && close[1] == quote) { // a doubled quote
+                        unescaped.append(segment, size_t(close + 1 - segment));
+                        segment = close + 2;
+                        copied = true;
+                    }
+                    if (close == nullptr) {
+                        if (!last)
+                            return false;
+                        close = d = end;
+                    }
+                    else if ((d = find_byte(close + 1, end, delimiter)) == nullptr)
+                        d = end;
+                    if (!copied && d == close + 1)
+                        value = std::string_view(segment, size_t(close - segment));
+                    else { // text after the closing quote is kept as is
+                        unescaped.append(segment, size_t(close - segment));
+                        if (close < end)
+                            unescaped.append(close + 1, size_t(d - close - 1));
+                        value = std::string_view(unescaped.data() + from, unescaped.size() - from);
+                    }
+                }
+                else {
+                    if ((d = find_byte(p, end, delimiter)) == nullptr)
+                        d = end;
+                    value = std::string_view(p, size_t(d - p));
+                }
+                if (needed)
+                    needed = set_field(column++, value);
+                if (d == end)
+                    return true;
+            }
+        }
+
+        static std::string_view without_cr(std::string_view line) {return !line.empty() && line.back() == '\r' ? line.substr(0, line.size() - 1) : line;}
+
+        void read_record()
+        {
+            if (!(has_record = !lines.empty()))
+                return;
+            std::string_view line = without_cr(lines.current());
+            if (parse(line, false))
+                return;
+            joined.assign(line.data(), line.size());
+            while (true) {
+                lines.advance();
+                if (lines.empty()) {
+                    lines_ended = true;
+                    parse(joined, true);
+                    return;
+                }
+                joined += '\n';
+                joined += without_cr(lines.current());
+                if (parse(joined, false))
+                    return;
+            }
+        }
+
+    public:
+        Cursor(const Records &records) : lines(records.lines.cursor()), delimiter(records.delimiter), quote(records.quote)
+        {
+            if (!records.columns.empty()) {
+                slots.assign(*std::max_element(records.columns.begin(), records.columns.end()) + 1, -1);
+                for (size_t i = 0; i < records.columns.size(); i++)
+                    slots[records.columns[i]] = int(i);
+                fields.resize(records.columns.size());
+            }
+            read_record();
+        }
+
+        static constexpr bool stable_current = false; // fields are views into the current line and the buffers of the cursor
+
+        bool empty() const {return !has_record;}
+        Record current() const {return Record(fields.data(), fields.size());}
+
+        void advance()
+        {
+            if (lines_ended)
+                has_record = false;
+            else {
+                lines.advance();
+                read_record();
+            }
+        }
+    };
+
+    Records(LinesContainer lines, char delimiter = ',', char quote = '"', std::vector<size_t> columns = {}) : lines(std::move(lines)), delimiter(delimiter), quote(quote), columns(std::move(columns)) {}
+
+    Cursor cursor() const {return Cursor(*this);}
+};
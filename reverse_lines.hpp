@@ -0,0 +1,110 @@
+#pragma once
+#include <sys/stat.h>
+#include "block_lines.hpp"
+
+// Lines of a file, last line first, read backwards from the end of the file in blocks of `block_size` bytes with pread(2).
+// Only the blocks holding the lines actually consumed are read, so getting the last lines of a huge file costs as little as the lines themselves.
+// Lines are split as by `FdLines` (a final newline does not end an empty last line), except that a line longer than `max_line_length` comes in pieces from its end on.
+class ReverseLines : public CursorProtocols<ReverseLines>
+{
+    const char *fname;
+    size_t block_size, max_line_length;
+
+public:
+    ReverseLines(const char *fname, size_t block_size = 256 << 10, size_t max_line_length = 1 << 20)
+        : fname(fname), block_size(std::max(block_size, size_t(1))), max_line_length(std::max(max_line_length, size_t(1))) {}
+
+    class Cursor
+    {
+        UniqueHandle<int, -1> fd;
+        size_t block_size, max_line_length, capacity;
+        std::unique_ptr<char[]> buffer; // a block read is put right before the unconsumed part of the previous one, which is moved to the end of the buffer
+        const char *lo = nullptr, *hi = nullptr; // the part of the file read but not consumed yet
+        int64_t lo_offset = 0; // file offset of `lo`
+        std::string_view line;
+        bool has_line = false, is_partial = false, first_line_taken = false;
+
+        bool read_previous_block()
+        {
+            size_t unconsumed = size_t(hi - lo), n = (size_t)std::min<int64_t>(int64_t(block_size), lo_offset);
+            char *end = buffer.get() + capacity;
+            memmove(end - unconsumed, lo, unconsumed);
+            char *dest = end - unconsumed - n;
+            for (size_t done = 0; done < n;) {
+                ssize_t r = pread(fd, dest + done, n - done, (off_t)(lo_offset - int64_t(n) + int64_t(done)));
+                if (r < 0 && errno == EINTR)
+                    continue;
+                if (r <= 0)
+                    return false;
+                done += size_t(r);
+            }
+            lo = dest;
+            hi = end;
+            lo_offset -= int64_t(n);
+            return true;
+        }
+
+    public:
+        Cursor(const char *fname, size_t block_size, size_t max_line_length)
+            : block_size(block_size), max_line_length(max_line_length), capacity(block_size + max_line_length), buffer(new char[capacity])
+        {
+            lo = hi = buffer.get() + capacity;
+            struct stat st;
+            first_line_taken = true;
+            if ((fd = open(fname, O_RDONLY | O_CLOEXEC)) == -1 || fstat(fd, &st) != 0 || st.st_size == 0)
+                return;
+            lo_offset = st.st_size;
+            if (!read_previous_block())
+                return;
+            first_line_taken = false;
+            if (hi[-1] == '\n')
+                hi--;
+            advance();
+        }
+        Cursor(Cursor &&) = default;
+        ~Cursor()
+        {
+            if (fd != -1)
+                close(fd);
+        }
+
+        static constexpr bool stable_current = false; // reading a block moves the unconsumed data
+
+        bool empty() const {return !has_line;}
+        std::string_view current() const {return line;}
+        bool partial() const {return is_partial;}
+
+        void advance()
+        {
+            is_partial = false;
+            while (true) {
+                const char *nl = find_last_byte(lo, hi, '\n');
+                if (size_t(hi - (nl != nullptr ? nl + 1 : lo)) > max_line_length) {
+                    line = std::string_view(hi - max_line_length, max_line_length);
+                    hi -= max_line_length;
+                    has_line = is_partial = true;
+                    return;
+                }
+                if (nl != nullptr) {
+                    line = std::string_view(nl + 1, size_t(hi - nl - 1));
+                    hi = nl;
+                    has_line = true;
+                    return;
+                }
+                if (lo_offset == 0) { // the first line of the file
+                    line = std::string_view(lo, size_t(hi - lo));
+                    hi = lo;
+                    has_line = !first_line_taken;
+                    first_line_taken = true;
+                    return;
+                }
+                if (!read_previous_block()) {
+                    has_line = false;
+                    return;
+                }
+            }
+        }
+    };
+
+    Cursor cursor() const {return Cursor(fname, block_size, max_line_length);}
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+// Fixed set of threads running one job at a time. A job consists of the tasks [0, count), which the threads take in increasing order, each thread taking the next task as soon as it has finished one.
+class ThreadPool
+{
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable job_posted, job_done;
+    std::function<void(size_t)> job;
+    size_t task_count = 0;
+    std::atomic<size_t> next_task{0};
+    unsigned running = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    static unsigned &this_worker()
+    {
+        static thread_local unsigned index = 0;
+        return index;
+    }
+
+    void work(unsigned index)
+    {
+        this_worker() = index;
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            job_posted.wait(lock, [&] {return stopping || generation != seen;});
+            if (stopping)
+                return;
+            seen = generation;
+            lock.unlock();
+            for (size_t task; (task = next_task++) < task_count;)
+                job(task);
+            lock.lock();
+            if (--running == 0)
+                job_done.notify_all();
+        }
+    }
+
+public:
+    explicit ThreadPool(unsigned size = 0)
+    {
+        if (size == 0)
+            size = std::max(std::thread::hardware_concurrency(), 1u);
+        for (unsigned i = 0; i < size; i++)
+            threads.emplace_back(&ThreadPool::work, this, i);
+    }
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        job_posted.notify_all();
+        for (std::thread &t : threads)
+            t.join();
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    void operator=(const ThreadPool &) = delete;
+
+    unsigned size() const {return (unsigned)threads.size();}
+
+    // Index in [0, size()) of the pool thread calling it
+    static unsigned worker_index() {return this_worker();}
+
+    // Starts calling `fn(task)` for every task in [0, count) on the pool threads. The previous job must have been waited for.
+    void start(size_t count, std::function<void(size_t)> fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = std::move(fn);
+        task_count = count;
+        next_task = 0;
+        running = size();
+        generation++;
+        job_posted.notify_all();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        job_done.wait(lock, [&] {return running == 0;});
+        job = nullptr;
+    }
+
+    void run(size_t count, std::function<void(size_t)> fn)
+    {
+        start(count, std::move(fn));
+        wait();
+    }
+};
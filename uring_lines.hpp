@@ -0,0 +1,320 @@
+#pragma once
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#include "block_lines.hpp"
+
+#if defined(IORING_OFF_SQ_RING) && defined(__NR_io_uring_setup)
+// Just enough of io_uring, set up with raw system calls (liburing is not required), to keep reads of a file (or statx calls) in flight
+class IoUring
+{
+    int ring_fd = -1;
+    void *sq_ptr = MAP_FAILED, *cq_ptr = MAP_FAILED;
+    size_t sq_len = 0, cq_len = 0;
+    io_uring_sqe *sqes = (io_uring_sqe*)MAP_FAILED;
+    size_t sqes_len = 0;
+    unsigned *sq_tail, *sq_mask, *sq_array, *cq_head, *cq_tail, *cq_mask;
+    io_uring_cqe *cqes;
+    unsigned to_submit = 0;
+
+    void close_ring()
+    {
+        if (sqes != MAP_FAILED)
+            munmap(sqes, sqes_len);
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+            munmap(cq_ptr, cq_len);
+        if (sq_ptr != MAP_FAILED)
+            munmap(sq_ptr, sq_len);
+        if (ring_fd != -1)
+            close(ring_fd);
+        ring_fd = -1;
+    }
+
+public:
+    IoUring() = default;
+    IoUring(const IoUring &) = delete;
+    void operator=(const IoUring &) = delete;
+    ~IoUring() {close_ring();}
+
+    // Returns false if io_uring is not available (an old kernel, or disabled by /proc/sys/kernel/io_uring_disabled or a seccomp filter)
+    bool setup(unsigned entries)
+    {
+        io_uring_params p = {};
+        if ((ring_fd = (int)syscall(__NR_io_uring_setup, entries, &p)) < 0) {
+            ring_fd = -1;
+            return false;
+        }
+        sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP)
+            sq_len = cq_len = std::max(sq_len, cq_len);
+        sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        cq_ptr = p.features & IORING_FEAT_SINGLE_MMAP ? sq_ptr : mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe*)mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if (sq_ptr == MAP_FAILED || cq_ptr == MAP_FAILED || sqes == MAP_FAILED) {
+            close_ring();
+            return false;
+        }
+        sq_tail  = (unsigned*)((char*)sq_ptr + p.sq_off.tail);
+        sq_mask  = (unsigned*)((char*)sq_ptr + p.sq_off.ring_mask);
+        sq_array = (unsigned*)((char*)sq_ptr + p.sq_off.array);
+        cq_head  = (unsigned*)((char*)cq_ptr + p.cq_off.head);
+        cq_tail  = (unsigned*)((char*)cq_ptr + p.cq_off.tail);
+        cq_mask  = (unsigned*)((char*)cq_ptr + p.cq_off.ring_mask);
+        cqes = (io_uring_cqe*)((char*)cq_ptr + p.cq_off.cqes);
+        return true;
+    }
+
+    // Queues a read into `iov`, which has to stay valid until its completion. No more reads than `entries` may be in flight.
+    void queue_readv(int fd, const iovec *iov, int64_t offset, uint64_t user_data)
+    {
+        unsigned tail = *sq_tail, index = tail & *sq_mask;
+        io_uring_sqe &sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.addr = (uint64_t)(uintptr_t)iov;
+        sqe.len = 1;
+        sqe.off = (uint64_t)offset;
+        sqe.user_data = user_data;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        to_submit++;
+    }
+
+#ifdef STATX_SIZE
+    // Queues a statx(2) of `path` relative to `dir_fd`; `path` and `buf` have to stay valid until its completion
+    void queue_statx(int dir_fd, const char *path, int flags, unsigned mask, struct statx *buf, uint64_t user_data)
+    {
+        unsigned tail = *sq_tail, index = tail & *sq_mask;
+        io_uring_sqe &sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_STATX;
+        sqe.fd = dir_fd;
+        sqe.addr = (uint64_t)(uintptr_t)path;
+        sqe.len = mask;
+        sqe.off = (uint64_t)(uintptr_t)buf;
+        sqe.statx_flags = (uint32_t)flags;
+        sqe.user_data = user_data;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        to_submit++;
+    }
+#endif
+
+    // Submits the queued operations and waits for at least `min_complete` completions
+    bool enter(unsigned min_complete)
+    {
+        while (to_submit > 0 || min_complete > 0) {
+            int r = (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            to_submit -= (unsigned)r;
+            if (min_complete > 0 || to_submit == 0)
+                break;
+        }
+        return true;
+    }
+
+    // Number of queued operations which `enter()` has not submitted yet (because it failed)
+    unsigned unsubmitted() const {return to_submit;}
+
+    // Calls `fn(user_data, result)` for every completion
+    template <typename Fn> void reap(Fn &&fn)
+    {
+        unsigned head = *cq_head, tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const io_uring_cqe &cqe = cqes[head & *cq_mask];
+            fn(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+};
+#else
+// Without <linux/io_uring.h>, `UringBlockSource` always falls back to pread(2)
+class IoUring
+{
+public:
+    bool setup(unsigned) {return false;}
+    void queue_readv(int, const iovec*, int64_t, uint64_t) {}
+#ifdef STATX_SIZE
+    void queue_statx(int, const char*, int, unsigned, struct statx*, uint64_t) {}
+#endif
+    bool enter(unsigned) {return false;}
+    unsigned unsubmitted() const {return 0;}
+    template <typename Fn> void reap(Fn &&) {}
+};
+#endif
+
+// Block source keeping reads of the next `depth` blocks of a file in flight through io_uring, so that the device is busy while the lines of the current block are processed.
+// A block returned by `next_block()` is released (its buffer is reused for the read of block `depth` positions further) at the next call. If io_uring is unavailable, or `use_io_uring` is false, blocks are read with pread(2) one at a time.
+class UringBlockSource
+{
+    static const int64_t pending = INT64_MIN;
+
+    struct State // the kernel refers to the buffers and `iovec`s, so they must not move with the source
+    {
+        UniqueHandle<int, -1> fd;
+        int64_t file_size = 0;
+        size_t depth, block_size;
+        std::unique_ptr<char[]> buffers;
+        std::unique_ptr<iovec[]> iovecs;
+        std::unique_ptr<int64_t[]> results; // per slot, bytes read or -errno, or `pending`
+        IoUring ring;
+        bool async = false;
+        unsigned in_flight = 0;
+        size_t next = 0; // block to be returned by `next_block()`
+        bool holding = false; // whether block `next - 1` is still in use
+        bool broken = false; // reads are in flight which could not be waited for, so no buffer can be reused
+
+        State(size_t depth, size_t block_size) : depth(depth), block_size(block_size), buffers(new char[depth * block_size]), iovecs(new iovec[depth]), results(new int64_t[depth]) {}
+
+        int64_t block_offset(size_t block) const {return int64_t(block) * int64_t(block_size);}
+        size_t block_len(size_t block) const {return (size_t)std::min<int64_t>(int64_t(block_size), file_size - block_offset(block));}
+
+        void queue(size_t block)
+        {
+            if (block_offset(block) >= file_size)
+                return;
+            size_t slot = block % depth;
+            iovecs[slot] = {&buffers[slot * block_size], block_len(block)};
+            results[slot] = pending;
+            ring.queue_readv(fd, &iovecs[slot], block_offset(block), block);
+            in_flight++;
+        }
+
+        void reap_completions()
+        {
+            ring.reap([this](uint64_t block, int32_t result) {
+                results[block % depth] = result;
+                in_flight--;
+            });
+        }
+
+        bool wait_for_completions()
+        {
+            if (!ring.enter(1))
+                return false;
+            reap_completions();
+            return true;
+        }
+
+        // Stops using io_uring after a failure of `enter()`. The reads in flight are waited for first, as their buffers are about to be reused by pread(2); returns false if they could not be.
+        bool fall_back_to_sync()
+        {
+            async = false;
+            for (int polls = 0; in_flight > ring.unsubmitted();)
+                if (!wait_for_completions()) { // the kernel fills the completion queue without `enter()`, so it is polled for up to 10 s
+                    if (++polls > 10000) {
+                        broken = true;
+                        return false;
+                    }
+                    usleep(1000);
+                    reap_completions();
+                }
+            in_flight = 0; // reads left in the submission queue are never submitted, as the ring is not entered any more
+            return true;
+        }
+
+        // Reads what is missing of a block with pread(2): all of it without io_uring, or the rest after a short read or a failure
+        bool read_sync(size_t block, size_t done)
+        {
+            size_t slot = block % depth, len = block_len(block);
+            while (done < len) {
+                ssize_t n = pread(fd, &buffers[slot * block_size + done], len - done, (off_t)(block_offset(block) + int64_t(done)));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                done += size_t(n);
+            }
+            results[slot] = int64_t(done);
+            return done > 0;
+        }
+    };
+    std::unique_ptr<State> state;
+
+public:
+    UringBlockSource(const char *fname, size_t depth, size_t block_size, bool use_io_uring) : state(new State(depth, block_size))
+    {
+        struct stat st;
+        if ((state->fd = open(fname, O_RDONLY | O_CLOEXEC)) == -1 || fstat(state->fd, &st) != 0)
+            return;
+        state->file_size = st.st_size;
+        if (use_io_uring && (state->async = state->ring.setup((unsigned)depth))) {
+            for (size_t block = 0; block < depth; block++)
+                state->queue(block);
+            if (!state->ring.enter(0))
+                state->fall_back_to_sync();
+        }
+    }
+    UringBlockSource(UringBlockSource &&) = default;
+    ~UringBlockSource()
+    {
+        if (state == nullptr)
+            return;
+        if (state->async)
+            state->fall_back_to_sync(); // the buffers must outlive the reads
+        if (state->broken) { // the kernel may still write into the buffers, so they are leaked rather than freed
+            state.release();
+            return;
+        }
+        if (state->fd != -1)
+            close(state->fd);
+    }
+
+    bool uses_io_uring() const {return state->async;}
+
+    std::string_view next_block()
+    {
+        State &s = *state;
+        if (s.holding) {
+            s.holding = false;
+            if (s.async) {
+                s.queue(s.next - 1 + s.depth);
+                if (!s.ring.enter(0)) // submitted right away, so that the read is in flight while the current blocks are processed
+                    s.fall_back_to_sync();
+            }
+        }
+        if (s.fd == -1 || s.broken || s.block_offset(s.next) >= s.file_size)
+            return std::string_view();
+        size_t block = s.next, slot = block % s.depth;
+        if (s.async)
+            while (s.results[slot] == pending)
+                if (!s.wait_for_completions() && !s.fall_back_to_sync())
+                    return std::string_view();
+        if (!s.async)
+            s.read_sync(block, 0);
+        else if (s.results[slot] < (int64_t)s.block_len(block)) // a short read or a failure
+            s.read_sync(block, size_t(std::max(s.results[slot], int64_t(0))));
+        if (s.results[slot] <= 0)
+            return std::string_view();
+        s.next++;
+        s.holding = true;
+        return std::string_view(&s.buffers[slot * s.block_size], size_t(s.results[slot]));
+    }
+};
+
+// Lines of a file whose next `depth` blocks of `block_size` bytes are read asynchronously through io_uring, falling back to pread(2) where io_uring is unavailable.
+// Iterating over it behaves as over `FdLines`.
+class UringLines : public CursorProtocols<UringLines>
+{
+    const char *fname;
+    size_t depth, block_size, max_line_length;
+    bool use_io_uring;
+
+public:
+    UringLines(const char *fname, size_t depth = 8, size_t block_size = 512 << 10, size_t max_line_length = 1 << 20, bool use_io_uring = true)
+        : fname(fname), depth(std::max(depth, size_t(1))), block_size(std::max(block_size, size_t(1))), max_line_length(max_line_length), use_io_uring(use_io_uring) {}
+
+    using Cursor = LineSplitter<UringBlockSource>;
+    Cursor cursor() const {return Cursor(UringBlockSource(fname, depth, block_size, use_io_uring), max_line_length);}
+};
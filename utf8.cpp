@@ -0,0 +1,20 @@
+#include "utf8.hpp"
+#include "block_lines.hpp"
+#include "dir_iter_posix.hpp"
+
+int main()
+{
+    // Invalid lines are skipped
+    print_iterable(Utf8Validated(FdLines("utf8.txt")));
+    std::cout << "\n\n";
+
+    // or have their invalid bytes replaced by U+FFFD
+    print_iterable(Utf8Validated(FdLines("utf8.txt"), InvalidUtf8::Replace));
+    std::cout << "\n\n";
+
+    // UTF-16 code units per line, and UTF-32 code units (code points) per name
+    Utf8Transcoded(FdLines("utf8.txt")).for_each([](std::u16string_view line) {std::cout << line.size() << ' ';});
+    std::cout << "\n\n";
+    Utf8Transcoded<Dir, char32_t>(Dir("testdir", false, NameFilter())).for_each([](std::u32string_view name) {std::cout << name.size() << ' ';});
+    std::cout << '\n';
+}
@@ -0,0 +1,338 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <stdint.h>
+#include <string.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "cursor_protocols.hpp"
+
+// Decodes the UTF-8 sequence at `p` (< `end`). Returns its length, with its code point in `cp`, or 0 if it is invalid: a stray continuation byte, a truncated sequence, an overlong encoding, a surrogate or a code point above U+10FFFF.
+inline size_t utf8_decode(const unsigned char *p, const unsigned char *end, char32_t &cp)
+{
+    unsigned c = p[0];
+    size_t len;
+    char32_t min;
+    if (c < 0x80) {
+        cp = c;
+        return 1;
+    }
+    if (c >= 0xC2 && c <= 0xDF)
+        len = 2, cp = c & 0x1F, min = 0x80;
+    else if (c >= 0xE0 && c <= 0xEF)
+        len = 3, cp = c & 0x0F, min = 0x800;
+    else if (c >= 0xF0 && c <= 0xF4)
+        len = 4, cp = c & 0x07, min = 0x10000;
+    else
+        return 0;
+    if (size_t(end - p) < len)
+        return 0;
+    for (size_t i = 1; i < len; i++) {
+        if ((p[i] & 0xC0) != 0x80)
+            return 0;
+        cp = cp << 6 | (p[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+        return 0;
+    return len;
+}
+
+#ifdef __AVX2__
+// The lookup-table UTF-8 validation of Keiser and Lemire ("Validating UTF-8 In Less Than One Instruction Per Byte", 2021), as in simdjson: every byte is classified by three 16-entry table lookups (the high and low nibbles of the previous byte, the high nibble of the byte), whose AND is nonzero exactly for the invalid 2-byte patterns; the continuations of 3- and 4-byte sequences are checked by comparing the bytes 2 and 3 positions back
+class Utf8Validator
+{
+    __m256i error = _mm256_setzero_si256(), prev_input = _mm256_setzero_si256(), prev_incomplete = _mm256_setzero_si256();
+
+    template <int N> static __m256i prev(__m256i input, __m256i prev_input) {return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - N);}
+
+    static __m256i table(char t0, char t1, char t2, char t3, char t4, char t5, char t6, char t7, char t8, char t9, char t10, char t11, char t12, char t13, char t14, char t15)
+    {
+        return _mm256_broadcastsi128_si256(_mm_setr_epi8(t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15));
+    }
+
+    static __m256i high_nibbles(__m256i v) {return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));}
+
+    static __m256i check_special_cases(__m256i input, __m256i prev1)
+    {
+        const char TOO_SHORT = 1 << 0, TOO_LONG = 1 << 1, OVERLONG_3 = 1 << 2, TOO_LARGE = 1 << 3, SURROGATE = 1 << 4, OVERLONG_2 = 1 << 5,
+                   TOO_LARGE_1000 = 1 << 6, OVERLONG_4 = 1 << 6, TWO_CONTS = char(1 << 7), CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+        __m256i byte_1_high = _mm256_shuffle_epi8(table(
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, // 0xxx: ASCII
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,                                     // 10xx: continuation
+            TOO_SHORT | OVERLONG_2,                                                         // 1100: 2-byte lead
+            TOO_SHORT,                                                                      // 1101: 2-byte lead
+            TOO_SHORT | OVERLONG_3 | SURROGATE,                                             // 1110: 3-byte lead
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4), high_nibbles(prev1));     // 1111: 4-byte lead
+        __m256i byte_1_low = _mm256_shuffle_epi8(table(
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY,
+            CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000),
+            _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+        __m256i byte_2_high = _mm256_shuffle_epi8(table(
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,       // 0xxx: ASCII
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,                  // 1000: continuation
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,                                   // 1001: continuation
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                                    // 1010: continuation
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                                    // 1011: continuation
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT), high_nibbles(input));                            // 11xx: lead
+        return _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+    }
+
+public:
+    void step(__m256i input)
+    {
+        if (_mm256_movemask_epi8(input) == 0) // ASCII, which is only an error after an incomplete sequence
+            error = _mm256_or_si256(error, prev_incomplete);
+        else {
+            __m256i special_cases = check_special_cases(input, prev<1>(input, prev_input));
+            // The 2nd and 3rd byte after a 3- or 4-byte lead are continuations, which the special cases flag as TWO_CONTS (0x80)
+            __m256i is_third_byte = _mm256_subs_epu8(prev<2>(input, prev_input), _mm256_set1_epi8(char(0xE0 - 0x80)));
+            __m256i is_fourth_byte = _mm256_subs_epu8(prev<3>(input, prev_input), _mm256_set1_epi8(char(0xF0 - 0x80)));
+            __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(char(0x80)));
+            error = _mm256_or_si256(error, _mm256_xor_si256(must_be_continuation, special_cases));
+            // A lead byte among the last 3 bytes, whose sequence goes on in the next block
+            const __m256i max_value = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                       -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+            prev_incomplete = _mm256_subs_epu8(input, max_value);
+        }
+        prev_input = input;
+    }
+
+    // Whether all the blocks were valid UTF-8, the last one ending with a complete sequence
+    bool valid() const {return _mm256_testz_si256(_mm256_or_si256(error, prev_incomplete), _mm256_or_si256(error, prev_incomplete)) != 0;}
+};
+#endif
+
+// Whether [p, end) is valid UTF-8.
+// With AVX2, 32 bytes are validated per step without branching on their content (see `Utf8Validator`), and a block of ASCII costs a single test; other builds skip ASCII 16 bytes at a time with SSE2 (or 8 without), and decode the rest.
+inline bool utf8_valid(const char *p, const char *end)
+{
+#ifdef __AVX2__
+    Utf8Validator validator;
+    for (; end - p >= 32; p += 32)
+        validator.step(_mm256_loadu_si256((const __m256i*)p));
+    alignas(32) char tail[32] = {}; // padded with ASCII, so that a truncated sequence at the end is an error
+    if (end > p)
+        memcpy(tail, p, size_t(end - p));
+    validator.step(_mm256_load_si256((const __m256i*)tail));
+    return validator.valid();
+#else
+    const unsigned char *u = (const unsigned char*)p, *u_end = (const unsigned char*)end;
+    while (u < u_end) {
+#ifdef __SSE2__
+        if (u_end - u >= 16 && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)u)) == 0) {
+            u += 16;
+            continue;
+        }
+#else
+        uint64_t word;
+        if (u_end - u >= 8 && (memcpy(&word, u, 8), (word & 0x8080808080808080) == 0)) {
+            u += 8;
+            continue;
+        }
+#endif
+        char32_t cp;
+        size_t len = utf8_decode(u, u_end, cp);
+        if (len == 0)
+            return false;
+        u += len;
+    }
+    return true;
+#endif
+}
+
+inline bool utf8_valid(std::string_view s) {return utf8_valid(s.data(), s.data() + s.size());}
+
+// Transcodes UTF-8 into UTF-16 (for a 2-byte `CharT`: char16_t, or wchar_t on Windows) or UTF-32 (char32_t, or wchar_t elsewhere), writing at most `in.size()` code units to `out`.
+// Every byte which does not start a valid sequence becomes U+FFFD, and clears `valid`. Returns the number of code units written.
+// Runs of ASCII are widened 32 bytes at a time with AVX2, or 16 with SSE2.
+template <typename CharT> size_t utf8_transcode(std::string_view in, CharT *out, bool &valid)
+{
+    static_assert(sizeof(CharT) == 2 || sizeof(CharT) == 4, "UTF-16 or UTF-32 code units");
+    const unsigned char *p = (const unsigned char*)in.data(), *end = p + in.size();
+    CharT *o = out;
+    valid = true;
+    while (p < end) {
+#ifdef __AVX2__
+        if (end - p >= 32 && _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)p)) == 0) {
+            if constexpr (sizeof(CharT) == 2)
+                for (int i = 0; i < 32; i += 16)
+                    _mm256_storeu_si256((__m256i*)(o + i), _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(p + i))));
+            else
+                for (int i = 0; i < 32; i += 8)
+                    _mm256_storeu_si256((__m256i*)(o + i), _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + i))));
+            p += 32;
+            o += 32;
+            continue;
+        }
+#elif defined(__SSE2__)
+        __m128i v;
+        if (end - p >= 16 && _mm_movemask_epi8(v = _mm_loadu_si128((const __m128i*)p)) == 0) {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i low = _mm_unpacklo_epi8(v, zero), high = _mm_unpackhi_epi8(v, zero);
+            if constexpr (sizeof(CharT) == 2) {
+                _mm_storeu_si128((__m128i*)o, low);
+                _mm_storeu_si128((__m128i*)(o + 8), high);
+            }
+            else {
+                _mm_storeu_si128((__m128i*)o, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128((__m128i*)(o + 4), _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128((__m128i*)(o + 8), _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128((__m128i*)(o + 12), _mm_unpackhi_epi16(high, zero));
+            }
+            p += 16;
+            o += 16;
+            continue;
+        }
+#endif
+        if (*p < 0x80) {
+            *o++ = CharT(*p++);
+            continue;
+        }
+        char32_t cp;
+        size_t len = utf8_decode(p, end, cp);
+        if (len == 0) {
+            valid = false;
+            cp = 0xFFFD;
+            len = 1;
+        }
+        p += len;
+        if (sizeof(CharT) == 2 && cp >= 0x10000) { // a surrogate pair, from a 4-byte sequence
+            *o++ = CharT(0xD800 + ((cp - 0x10000) >> 10));
+            *o++ = CharT(0xDC00 + (cp & 0x3FF));
+        }
+        else
+            *o++ = CharT(cp);
+    }
+    return size_t(o - out);
+}
+
+// What the UTF-8 adapters do with an element which is not valid UTF-8
+enum class InvalidUtf8 {Skip, Replace, Stop}; // skip it, replace every invalid byte by U+FFFD, or end the iteration there
+
+// Elements (lines, names) of a container with a `cursor()`, checked to be valid UTF-8 by `utf8_valid()`, so that code downstream can rely on it without checking every element again
+template <typename Container> class Utf8Validated : public CursorProtocols<Utf8Validated<Container>>
+{
+    Container container;
+    InvalidUtf8 invalid;
+
+public:
+    class Cursor
+    {
+        decltype(std::declval<const Container&>().cursor()) elements;
+        InvalidUtf8 invalid;
+        std::string_view element;
+        std::string replaced;
+        bool has_element = false;
+
+        void find_valid()
+        {
+            for (; !elements.empty(); elements.advance()) {
+                std::string_view s = elements.current();
+                if (utf8_valid(s)) {
+                    element = s;
+                    has_element = true;
+                    return;
+                }
+                if (invalid == InvalidUtf8::Stop)
+                    break;
+                if (invalid == InvalidUtf8::Replace) {
+                    replaced.clear();
+                    for (const unsigned char *p = (const unsigned char*)s.data(), *end = p + s.size(); p < end;) {
+                        char32_t cp;
+                        size_t len = utf8_decode(p, end, cp);
+                        if (len > 0)
+                            replaced.append((const char*)p, len);
+                        else
+                            replaced += "\xEF\xBF\xBD"; // U+FFFD
+                        p += std::max(len, size_t(1));
+                    }
+                    element = replaced;
+                    has_element = true;
+                    return;
+                }
+            }
+            has_element = false;
+        }
+
+    public:
+        Cursor(const Utf8Validated &validated) : elements(validated.container.cursor()), invalid(validated.invalid) {find_valid();}
+
+        static constexpr bool stable_current = false;
+
+        bool empty() const {return !has_element;}
+        std::string_view current() const {return element;}
+
+        void advance()
+        {
+            elements.advance();
+            find_valid();
+        }
+    };
+
+    Utf8Validated(Container container, InvalidUtf8 invalid = InvalidUtf8::Skip) : container(std::move(container)), invalid(invalid) {}
+
+    Cursor cursor() const {return Cursor(*this);}
+};
+
+// Elements of a container with a `cursor()` transcoded from UTF-8 into views of UTF-16 (`CharT` = char16_t) or UTF-32 (char32_t) code units, in a buffer of the cursor which is reused from one element to the next (see `utf8_transcode()`).
+// With `CharT` = wchar_t, elements are what std::wstring holds on the platform, as for the names of `Dir` on Windows and std::wcout.
+template <typename Container, typename CharT = char16_t> class Utf8Transcoded : public CursorProtocols<Utf8Transcoded<Container, CharT>>
+{
+    Container container;
+    InvalidUtf8 invalid;
+
+public:
+    class Cursor
+    {
+        decltype(std::declval<const Container&>().cursor()) elements;
+        InvalidUtf8 invalid;
+        std::unique_ptr<CharT[]> buffer;
+        size_t capacity = 0;
+        std::basic_string_view<CharT> element;
+        bool has_element = false;
+
+        void transcode()
+        {
+            for (; !elements.empty(); elements.advance()) {
+                std::string_view s = elements.current();
+                if (s.size() > capacity) {
+                    capacity = std::max(s.size(), capacity * 2);
+                    buffer.reset(new CharT[capacity]);
+                }
+                bool valid;
+                element = std::basic_string_view<CharT>(buffer.get(), utf8_transcode(s, buffer.get(), valid));
+                if (valid || invalid == InvalidUtf8::Replace) {
+                    has_element = true;
+                    return;
+                }
+                if (invalid == InvalidUtf8::Stop)
+                    break;
+            }
+            has_element = false;
+        }
+
+    public:
+        Cursor(const Utf8Transcoded &transcoded) : elements(transcoded.container.cursor()), invalid(transcoded.invalid), buffer(new CharT[256]), capacity(256) {transcode();}
+
+        static constexpr bool stable_current = false; // an element is a view into the buffer
+
+        bool empty() const {return !has_element;}
+        std::basic_string_view<CharT> current() const {return element;}
+
+        void advance()
+        {
+            elements.advance();
+            transcode();
+        }
+    };
+
+    Utf8Transcoded(Container container, InvalidUtf8 invalid = InvalidUtf8::Replace) : container(std::move(container)), invalid(invalid) {}
+
+    Cursor cursor() const {return Cursor(*this);}
+};
@@ -0,0 +1,27 @@
+#include "cursor_protocols.hpp"
+#include "array.hpp"
+#include "range.hpp"
+#include "linked_list.hpp"
+#include "read_lines.hpp"
+
+int main()
+{
+    Array<int, 10> array;
+    array.append(1);
+    array.append(4);
+    array.append(3);
+    print_iterable(via_cursor(array));
+    std::cout << "\n\n";
+
+    print_iterable(via_cursor(Range(1, 10)));
+    std::cout << "\n\n";
+
+    List<int> list;
+    list.append(1);
+    list.append(3);
+    list.append(4);
+    print_iterable(via_cursor(list));
+    std::cout << "\n\n";
+
+    print_iterable(via_cursor(Lines("lines.txt")));
+}